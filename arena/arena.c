@@ -0,0 +1,208 @@
+/*----- System Includes -----*/
+
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/*----- Project Includes -----*/
+
+#include "arena.h"
+
+/*----- Function Implementations -----*/
+
+inline static void sanity_check(arena_t const* arena) {
+  // Make sure our basic invariants hold.
+  assert(arena && arena->head && arena->head->used <= arena->head->size);
+}
+
+inline static int is_pow2(size_t val) {
+  return val && !(val & (val - 1));
+}
+
+inline static size_t align_offset(arena_block_t const* block, size_t align) {
+  // Work out how far into the block the next allocation
+  // with this alignment would start.
+  // We align the address itself, not the offset, since
+  // blocks aren't necessarily aligned to more than 16 bytes.
+  uintptr_t curr = (uintptr_t) (block->data + block->used);
+  uintptr_t aligned = (curr + (align - 1)) & ~((uintptr_t) align - 1);
+  return block->used + (aligned - curr);
+}
+
+static arena_block_t* alloc_block(arena_t* arena, size_t size) {
+  // Allocate the header and the usable space together,
+  // as long as their total doesn't wrap around.
+  if (size > SIZE_MAX - sizeof(arena_block_t)) return NULL;
+  size_t total = sizeof(arena_block_t) + size;
+  arena_block_t* block;
+  if (arena->backing == ARENA_MMAP) {
+    block = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) return NULL;
+  } else {
+    block = malloc(total);
+    if (!block) return NULL;
+  }
+
+  block->data = (char*) (block + 1);
+  block->size = size;
+  block->used = 0;
+  block->prev = NULL;
+  return block;
+}
+
+static void free_block(arena_t* arena, arena_block_t* block) {
+  // The first block of a static arena belongs to our caller.
+  if (block == &arena->first) return;
+  if (arena->backing == ARENA_MMAP) {
+    munmap(block, sizeof(arena_block_t) + block->size);
+  } else {
+    free(block);
+  }
+}
+
+int arena_init(arena_t* arena, arena_backing_t backing, size_t block_size) {
+  if (!arena || backing == ARENA_STATIC) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  arena->backing = backing;
+  arena->block_size = block_size ? block_size : ARENA_DEFAULT_BLOCK;
+  arena->head = alloc_block(arena, arena->block_size);
+  if (!arena->head) {
+    errno = ENOMEM;
+    return -1;
+  }
+  return 0;
+}
+
+int arena_init_static(arena_t* arena, void* buffer, size_t len) {
+  if (!arena || !buffer) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Our only block is the caller's buffer, with its header
+  // stored in the arena itself.
+  arena->backing = ARENA_STATIC;
+  arena->block_size = len;
+  arena->first.prev = NULL;
+  arena->first.data = (char*) buffer;
+  arena->first.size = len;
+  arena->first.used = 0;
+  arena->head = &arena->first;
+  return 0;
+}
+
+void arena_destroy(arena_t* arena) {
+  // Free every block in the chain.
+  while (arena->head) {
+    arena_block_t* prev = arena->head->prev;
+    free_block(arena, arena->head);
+    arena->head = prev;
+  }
+}
+
+void* arena_alloc(arena_t* arena, size_t len) {
+  return arena_alloc_aligned(arena, len, ARENA_DEFAULT_ALIGN);
+}
+
+void* arena_alloc_aligned(arena_t* arena, size_t len, size_t align) {
+  // Check error conditions.
+  sanity_check(arena);
+  if (!is_pow2(align)) {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  // The common case is a bump of the current block.
+  arena_block_t* block = arena->head;
+  size_t start = align_offset(block, align);
+  if (start > block->size || len > block->size - start) {
+    // Static arenas can't grow.
+    if (arena->backing == ARENA_STATIC) {
+      errno = ENOMEM;
+      return NULL;
+    }
+
+    // Chain on a new block, big enough for this allocation even
+    // if it's larger than our usual block size.
+    size_t size = arena->block_size;
+    if (len > SIZE_MAX - sizeof(arena_block_t) - align) {
+      errno = ENOMEM;
+      return NULL;
+    }
+    if (len + align > size) size = len + align;
+    block = alloc_block(arena, size);
+    if (!block) {
+      errno = ENOMEM;
+      return NULL;
+    }
+    block->prev = arena->head;
+    arena->head = block;
+    start = align_offset(block, align);
+  }
+
+  // Bump and return.
+  block->used = start + len;
+  return block->data + start;
+}
+
+void* arena_realloc(arena_t* arena, void* ptr, size_t old_len, size_t new_len) {
+  // Check error conditions.
+  sanity_check(arena);
+  if (!ptr) return arena_alloc(arena, new_len);
+
+  // If this was the last thing we handed out, we can just move
+  // the bump pointer, as long as the block has room.
+  arena_block_t* block = arena->head;
+  size_t start = (char*) ptr - block->data;
+  int last = (char*) ptr >= block->data && start + old_len == block->used;
+  if (last && new_len <= block->size - start) {
+    block->used = start + new_len;
+    return ptr;
+  } else if (new_len <= old_len) {
+    // Shrinking something in the middle of a block, nothing to do.
+    return ptr;
+  }
+
+  // Otherwise, copy into a fresh allocation.
+  void* fresh = arena_alloc(arena, new_len);
+  if (fresh) memcpy(fresh, ptr, old_len);
+  return fresh;
+}
+
+arena_mark_t arena_mark(arena_t const* arena) {
+  sanity_check(arena);
+  arena_mark_t mark = {arena->head, arena->head->used};
+  return mark;
+}
+
+void arena_rollback(arena_t* arena, arena_mark_t mark) {
+  // Release any blocks chained on since the mark was taken,
+  // then rewind the block that was current at the time.
+  sanity_check(arena);
+  while (arena->head != mark.block) {
+    arena_block_t* prev = arena->head->prev;
+    assert(prev);
+    free_block(arena, arena->head);
+    arena->head = prev;
+  }
+  assert(mark.used <= arena->head->used);
+  arena->head->used = mark.used;
+}
+
+void arena_reset(arena_t* arena) {
+  // Release everything but the first block, and rewind it.
+  sanity_check(arena);
+  while (arena->head->prev) {
+    arena_block_t* prev = arena->head->prev;
+    free_block(arena, arena->head);
+    arena->head = prev;
+  }
+  arena->head->used = 0;
+}
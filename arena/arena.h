@@ -0,0 +1,77 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/*----- System Includes -----*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+/*----- Numerical Constants -----*/
+
+// Alignment used by arena_alloc, enough for any basic type.
+#define ARENA_DEFAULT_ALIGN        (16)
+#define ARENA_DEFAULT_BLOCK        (64 * 1024)
+
+/*----- Type Declarations -----*/
+
+// Where an arena gets its memory from.
+// A static arena wraps a caller-provided buffer and can't grow.
+// Malloc and mmap arenas chain on new blocks as they fill up.
+typedef enum arena_backing {
+  ARENA_STATIC,
+  ARENA_MALLOC,
+  ARENA_MMAP
+} arena_backing_t;
+
+// Blocks are chained newest first.
+// For malloc and mmap arenas, the header sits at the front
+// of the block's own allocation.
+typedef struct arena_block {
+  struct arena_block* prev;
+  char* data;
+  size_t size, used;
+} arena_block_t;
+
+typedef struct arena {
+  arena_block_t* head;
+  arena_block_t first;
+  arena_backing_t backing;
+  size_t block_size;
+} arena_t;
+
+// A saved allocation position, see arena_mark.
+typedef struct arena_mark {
+  arena_block_t* block;
+  size_t used;
+} arena_mark_t;
+
+/*----- Function Declarations -----*/
+
+// Lifecycle functions
+// block_size is the usable size of each chained block, or zero
+// for ARENA_DEFAULT_BLOCK. Static arenas use arena_init_static.
+int arena_init(arena_t* arena, arena_backing_t backing, size_t block_size);
+int arena_init_static(arena_t* arena, void* buffer, size_t len);
+void arena_destroy(arena_t* arena);
+
+// Allocation
+// There is no per-allocation free, memory comes back all at once
+// through arena_rollback, arena_reset or arena_destroy.
+// align must be a power of two.
+void* arena_alloc(arena_t* arena, size_t len);
+void* arena_alloc_aligned(arena_t* arena, size_t len, size_t align);
+
+// Resizes an allocation. The most recent allocation grows or
+// shrinks in place when its block has room, anything else is
+// copied into a fresh allocation.
+void* arena_realloc(arena_t* arena, void* ptr, size_t old_len, size_t new_len);
+
+// Scopes
+// arena_rollback releases everything allocated since the mark
+// was taken, and arena_reset releases everything.
+arena_mark_t arena_mark(arena_t const* arena);
+void arena_rollback(arena_t* arena, arena_mark_t mark);
+void arena_reset(arena_t* arena);
+
+#endif
@@ -0,0 +1,104 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "arena.h"
+
+/*----- Numerical Constants -----*/
+
+#define BLOCK_SIZE        (1024)
+#define NUM_ALLOCS        (100)
+
+/*----- Function Implementations -----*/
+
+void check_arena(arena_t* arena) {
+  // Allocations should respect alignment, and shouldn't overlap.
+  char* prev = NULL;
+  for (size_t align = 1; align <= 256; align *= 2) {
+    char* curr = arena_alloc_aligned(arena, 3, align);
+    assert(curr && !((uintptr_t) curr % align));
+    memset(curr, 0xff, 3);
+    if (prev) assert(prev[0] == (char) 0xff);
+    prev = curr;
+  }
+  assert(!arena_alloc_aligned(arena, 8, 3) && errno == EINVAL);
+
+  // Allocate well past a single block, so that we chain on more.
+  arena_mark_t mark = arena_mark(arena);
+  int64_t* vals[NUM_ALLOCS];
+  for (int64_t i = 0; i < NUM_ALLOCS; ++i) {
+    vals[i] = arena_alloc(arena, sizeof(int64_t) * 16);
+    assert(vals[i] && !((uintptr_t) vals[i] % ARENA_DEFAULT_ALIGN));
+    *vals[i] = i;
+  }
+  for (int64_t i = 0; i < NUM_ALLOCS; ++i) assert(*vals[i] == i);
+  assert(arena->head->prev);
+
+  // A single allocation bigger than a block still works.
+  char* big = arena_alloc(arena, BLOCK_SIZE * 4);
+  assert(big);
+  memset(big, 0, BLOCK_SIZE * 4);
+
+  // Rolling back should release the chained blocks, and
+  // hand out the same memory again.
+  arena_rollback(arena, mark);
+  assert(arena->head == mark.block && arena->head->used == mark.used);
+  assert(arena_alloc(arena, sizeof(int64_t) * 16) == (void*) vals[0]);
+
+  // The latest allocation should grow in place,
+  // anything else gets copied.
+  char* grown = arena_alloc(arena, 16);
+  strcpy(grown, "in place");
+  assert(arena_realloc(arena, grown, 16, 64) == grown);
+  char* moved = arena_realloc(arena, vals[0], sizeof(int64_t) * 16, BLOCK_SIZE);
+  assert(moved && moved != (char*) vals[0] && *(int64_t*) moved == 0);
+  assert(!strcmp(grown, "in place"));
+
+  // Resetting should rewind all the way to the start.
+  arena_reset(arena);
+  assert(!arena->head->prev && !arena->head->used);
+}
+
+int main() {
+  // Exercise both growable backings.
+  arena_backing_t backings[] = {ARENA_MALLOC, ARENA_MMAP};
+  for (size_t i = 0; i < sizeof(backings) / sizeof(*backings); ++i) {
+    arena_t arena;
+    int err = arena_init(&arena, backings[i], BLOCK_SIZE);
+    assert(!err);
+    check_arena(&arena);
+
+    // Requests so large the block header would wrap the size
+    // around fail cleanly, and leave the arena usable.
+    assert(!arena_alloc(&arena, SIZE_MAX - 40) && errno == ENOMEM);
+    assert(!arena_alloc(&arena, SIZE_MAX) && errno == ENOMEM);
+    assert(arena_alloc(&arena, 8));
+    arena_destroy(&arena);
+    assert(arena_init(&arena, backings[i], SIZE_MAX - 8) && errno == ENOMEM);
+  }
+
+  // A static arena hands out its buffer and then fails.
+  static char buffer[BLOCK_SIZE];
+  arena_t arena;
+  int err = arena_init_static(&arena, buffer, sizeof(buffer));
+  assert(!err);
+  char* first = arena_alloc(&arena, BLOCK_SIZE / 2);
+  assert(first >= buffer && first < buffer + sizeof(buffer));
+  assert(!arena_alloc(&arena, BLOCK_SIZE) && errno == ENOMEM);
+
+  // It still supports scopes.
+  arena_mark_t mark = arena_mark(&arena);
+  assert(arena_alloc(&arena, 8));
+  arena_rollback(&arena, mark);
+  arena_reset(&arena);
+  assert(arena_alloc(&arena, BLOCK_SIZE / 2) == first);
+  arena_destroy(&arena);
+
+  // Static arenas have to be set up with arena_init_static.
+  assert(arena_init(&arena, ARENA_STATIC, 0) && errno == EINVAL);
+  return 0;
+}
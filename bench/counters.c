@@ -0,0 +1,90 @@
+/*----- System Includes -----*/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/*----- Project Includes -----*/
+
+#include "counters.h"
+
+/*----- Globals -----*/
+
+static uint64_t const configs[COUNTER_COUNT] = {
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES
+};
+
+/*----- Function Implementations -----*/
+
+static int read_group(counters_t* ctr, uint64_t* out) {
+  // A group read comes back as the number of counters,
+  // followed by each of their values.
+  uint64_t buf[COUNTER_COUNT + 1];
+  if (read(ctr->fds[0], buf, sizeof(buf)) != sizeof(buf)) return -1;
+  memcpy(out, buf + 1, sizeof(uint64_t) * COUNTER_COUNT);
+  return 0;
+}
+
+static int open_counter(uint64_t config, int group) {
+  // Count this thread, on any cpu, in user space only, so the
+  // syscalls that start and stop the counters don't show up.
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+int counters_open(counters_t* ctr) {
+  // Open every counter in one group, led by the first, so they
+  // all count over exactly the same instructions.
+  memset(ctr, 0, sizeof(*ctr));
+  for (int i = 0; i < COUNTER_COUNT; ++i) ctr->fds[i] = -1;
+  for (int i = 0; i < COUNTER_COUNT; ++i) {
+    ctr->fds[i] = open_counter(configs[i], i ? ctr->fds[0] : -1);
+    if (ctr->fds[i] < 0) {
+      int err = errno;
+      counters_close(ctr);
+      errno = err;
+      return -1;
+    }
+  }
+  ctr->available = true;
+  errno = 0;
+  return 0;
+}
+
+void counters_close(counters_t* ctr) {
+  for (int i = 0; i < COUNTER_COUNT; ++i) {
+    if (ctr->fds[i] >= 0) close(ctr->fds[i]);
+    ctr->fds[i] = -1;
+  }
+  ctr->available = false;
+}
+
+void counters_start(counters_t* ctr) {
+  if (ctr->available && read_group(ctr, ctr->start)) ctr->available = false;
+}
+
+void counters_stop(counters_t* ctr) {
+  uint64_t end[COUNTER_COUNT];
+  if (!ctr->available) return;
+  if (read_group(ctr, end)) {
+    ctr->available = false;
+    return;
+  }
+  for (int i = 0; i < COUNTER_COUNT; ++i) ctr->totals[i] += end[i] - ctr->start[i];
+}
+
+void counters_reset(counters_t* ctr) {
+  memset(ctr->totals, 0, sizeof(ctr->totals));
+}
@@ -0,0 +1,47 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+/*----- System Includes -----*/
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+/*----- Type Declarations -----*/
+
+// The hardware counters we read around each timed region.
+typedef enum counter_kind {
+  COUNTER_INSTRUCTIONS,
+  COUNTER_CACHE_MISSES,
+  COUNTER_COUNT
+} counter_kind_t;
+
+// A group of user-space hardware counters for the calling thread.
+// Opening them can fail for plenty of reasons that aren't ours to
+// fix (perf_event_paranoid, containers, virtual machines without a
+// PMU), so every call works on an unavailable group too, and just
+// reads back zeros.
+// The group runs from open to close, and start and stop read it in
+// a single syscall each, rather than switching it on and off.
+typedef struct counters {
+  int fds[COUNTER_COUNT];
+  bool available;
+  uint64_t start[COUNTER_COUNT];
+  uint64_t totals[COUNTER_COUNT];
+} counters_t;
+
+/*----- Function Declarations -----*/
+
+// Lifecycle functions
+// counters_open returns -1 and sets errno if the counters aren't
+// available, but leaves the group usable either way.
+int counters_open(counters_t* ctr);
+void counters_close(counters_t* ctr);
+
+// Counting operations
+// Counts accumulate in totals across every start/stop pair,
+// until counters_reset.
+void counters_start(counters_t* ctr);
+void counters_stop(counters_t* ctr);
+void counters_reset(counters_t* ctr);
+
+#endif
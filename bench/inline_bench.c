@@ -0,0 +1,120 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "../int_stack/sstack_inline.h"
+#include "../gen_stack/gstack_inline.h"
+#include "../dyn_stack/dstack_inline.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_OPS           (100000000LL)
+#define DEPTH                 (1024)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Each round pushes to a fixed depth, then peeks and pops its way
+// back down, which is three operations per record.
+// The two versions of each loop differ only in which calls they
+// make.
+#define DEFINE_ROUNDS(name, type, depth, push, peek, pop, size)               \
+  static int64_t name(type* stk, int64_t rounds) {                            \
+    int64_t sum = 0;                                                          \
+    for (int64_t round = 0; round < rounds; ++round) {                        \
+      for (int64_t val = 0; val < depth; ++val) push(stk, &val);              \
+      while (size(stk)) {                                                     \
+        sum += *(int64_t*) peek(stk);                                         \
+        pop(stk);                                                             \
+      }                                                                       \
+    }                                                                         \
+    return sum;                                                               \
+  }
+
+DEFINE_ROUNDS(sstack_calls, sstack_t, SSTACK_SIZE,
+    sstack_push, sstack_peek, sstack_pop, sstack_size)
+DEFINE_ROUNDS(sstack_inlined, sstack_t, SSTACK_SIZE,
+    sstack_push_inline, sstack_peek_inline, sstack_pop_inline, sstack_size_inline)
+DEFINE_ROUNDS(gstack_calls, gstack_t, DEPTH,
+    gstack_push, gstack_peek, gstack_pop, gstack_size)
+DEFINE_ROUNDS(gstack_inlined, gstack_t, DEPTH,
+    gstack_push_inline, gstack_peek_inline, gstack_pop_inline, gstack_size_inline)
+DEFINE_ROUNDS(dstack_calls, dstack_t, DEPTH,
+    dstack_push, dstack_peek, dstack_pop, dstack_size)
+DEFINE_ROUNDS(dstack_inlined, dstack_t, DEPTH,
+    dstack_push_inline, dstack_peek_inline, dstack_pop_inline, dstack_size_inline)
+
+static void report(char const* name, double calls, double inlined, double ops) {
+  printf("%s: out of line %.2f ns/op, inline %.2f ns/op, %.2fx\n",
+      name, calls * 1e9 / ops, inlined * 1e9 / ops, calls / inlined);
+}
+
+int main(int argc, char** argv) {
+  // Usage: inline_bench [ops]
+  int64_t ops = DEFAULT_OPS;
+  if (argc >= 2) ops = strtoll(argv[1], NULL, 10);
+  if (ops <= 0) {
+    fprintf(stderr, "Usage: %s [ops]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  sstack_t sstk;
+  gstack_t gstk;
+  dstack_t dstk;
+  if (sstack_init(&sstk) || gstack_init(&gstk, sizeof(int64_t))
+      || dstack_init(&dstk, sizeof(int64_t), NULL)) {
+    perror("init");
+    return EXIT_FAILURE;
+  }
+
+  // Warm each stack up to its working size first, so neither
+  // version pays for growth.
+  gstack_calls(&gstk, 1);
+  dstack_calls(&dstk, 1);
+
+  int64_t sums[2];
+  int64_t rounds = ops / (3 * SSTACK_SIZE);
+  double start = now();
+  sums[0] = sstack_calls(&sstk, rounds);
+  double calls = now() - start;
+  start = now();
+  sums[1] = sstack_inlined(&sstk, rounds);
+  double inlined = now() - start;
+  if (sums[0] != sums[1]) return EXIT_FAILURE;
+  report("sstack", calls, inlined, 3.0 * SSTACK_SIZE * rounds);
+
+  rounds = ops / (3 * DEPTH);
+  start = now();
+  sums[0] = gstack_calls(&gstk, rounds);
+  calls = now() - start;
+  start = now();
+  sums[1] = gstack_inlined(&gstk, rounds);
+  inlined = now() - start;
+  if (sums[0] != sums[1]) return EXIT_FAILURE;
+  report("gstack", calls, inlined, 3.0 * DEPTH * rounds);
+
+  start = now();
+  sums[0] = dstack_calls(&dstk, rounds);
+  calls = now() - start;
+  start = now();
+  sums[1] = dstack_inlined(&dstk, rounds);
+  inlined = now() - start;
+  if (sums[0] != sums[1]) return EXIT_FAILURE;
+  report("dstack", calls, inlined, 3.0 * DEPTH * rounds);
+
+  sstack_destroy(&sstk);
+  gstack_destroy(&gstk);
+  dstack_destroy(&dstk);
+  return 0;
+}
@@ -0,0 +1,467 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "../int_stack/sstack.h"
+#include "../gen_stack/gstack.h"
+#include "../dyn_stack/dstack.h"
+#include "../col_stack/colstack.h"
+#include "../typed_stack/tstack.h"
+#include "../prng/prng.h"
+#include "counters.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_OPS           (1LL << 22)
+#define MIN_ROUNDS            (32)
+#define MAX_ROUNDS            (4096)
+#define CALIBRATION_ROUNDS    (1000)
+#define SEED                  (42)
+
+/*----- Type Declarations -----*/
+
+typedef enum op {
+  OP_PUSH,
+  OP_POP,
+  OP_PEEK
+} op_t;
+
+typedef enum workload {
+  WORKLOAD_PUSH,
+  WORKLOAD_POP,
+  WORKLOAD_MIXED,
+  WORKLOAD_PEEK,
+  WORKLOAD_COUNT
+} workload_t;
+
+typedef struct rec8 { char bytes[8]; } rec8_t;
+typedef struct rec64 { char bytes[64]; } rec64_t;
+typedef struct rec256 { char bytes[256]; } rec256_t;
+
+DEFINE_STACK(tstack8, rec8_t)
+DEFINE_STACK(tstack64, rec64_t)
+DEFINE_STACK(tstack256, rec256_t)
+
+// Room for any of the stacks we drive.
+typedef union any_stack {
+  sstack_t sstack;
+  gstack_t gstack;
+  dstack_t dstack;
+  colstack_t colstack;
+  tstack8_t tstack8;
+  tstack64_t tstack64;
+  tstack256_t tstack256;
+} any_stack_t;
+
+// Every stack is driven through the same table of calls, so they
+// all pay the same indirect call per operation, and the numbers
+// compare the stacks rather than what the compiler could inline.
+// max_depth is zero for stacks that grow without bound.
+typedef struct stack_ops {
+  char const* name;
+  size_t max_depth;
+  int (*supports) (size_t record_size);
+  int (*init) (any_stack_t* stk, size_t record_size);
+  void (*destroy) (any_stack_t* stk);
+  int (*push) (any_stack_t* stk, void const* val);
+  void* (*peek) (any_stack_t* stk);
+  int (*pop) (any_stack_t* stk);
+  size_t (*size) (any_stack_t const* stk);
+} stack_ops_t;
+
+// The operations timed in a single round, and the depth the stack
+// is brought back to, untimed, before each round starts.
+typedef struct script {
+  uint8_t* ops;
+  size_t len, prefill;
+} script_t;
+
+typedef struct result {
+  double mean, p50, p90, p99, max;
+  double instructions, cache_misses;
+  int64_t rounds;
+} result_t;
+
+/*----- Function Declarations -----*/
+
+static int any_size(size_t record_size);
+static int word_size(size_t record_size);
+static int column_size(size_t record_size);
+
+/*----- Adapter Implementations -----*/
+
+static int sstack_adapt_init(any_stack_t* stk, size_t record_size) {
+  (void) record_size;
+  return sstack_init(&stk->sstack);
+}
+static void sstack_adapt_destroy(any_stack_t* stk) { sstack_destroy(&stk->sstack); }
+static int sstack_adapt_push(any_stack_t* stk, void const* val) { return sstack_push(&stk->sstack, val); }
+static void* sstack_adapt_peek(any_stack_t* stk) { return sstack_peek(&stk->sstack); }
+static int sstack_adapt_pop(any_stack_t* stk) { return sstack_pop(&stk->sstack); }
+static size_t sstack_adapt_size(any_stack_t const* stk) { return sstack_size(&stk->sstack); }
+
+static int gstack_adapt_init(any_stack_t* stk, size_t record_size) {
+  return gstack_init(&stk->gstack, record_size);
+}
+static void gstack_adapt_destroy(any_stack_t* stk) { gstack_destroy(&stk->gstack); }
+static int gstack_adapt_push(any_stack_t* stk, void const* val) { return gstack_push(&stk->gstack, val); }
+static void* gstack_adapt_peek(any_stack_t* stk) { return gstack_peek(&stk->gstack); }
+static int gstack_adapt_pop(any_stack_t* stk) { return gstack_pop(&stk->gstack); }
+static size_t gstack_adapt_size(any_stack_t const* stk) { return gstack_size(&stk->gstack); }
+
+static int dstack_adapt_init(any_stack_t* stk, size_t record_size) {
+  return dstack_init(&stk->dstack, record_size, NULL);
+}
+static void dstack_adapt_destroy(any_stack_t* stk) { dstack_destroy(&stk->dstack); }
+static int dstack_adapt_push(any_stack_t* stk, void const* val) { return dstack_push(&stk->dstack, val); }
+static void* dstack_adapt_peek(any_stack_t* stk) { return dstack_peek(&stk->dstack); }
+static int dstack_adapt_pop(any_stack_t* stk) { return dstack_pop(&stk->dstack); }
+static size_t dstack_adapt_size(any_stack_t const* stk) { return dstack_size(&stk->dstack); }
+
+static int colstack_adapt_init(any_stack_t* stk, size_t record_size) {
+  // Split the record into as many word sized (or larger) fields
+  // as the stack allows.
+  size_t fields = record_size / sizeof(int64_t);
+  if (fields > COLSTACK_MAX_FIELDS) fields = COLSTACK_MAX_FIELDS;
+  size_t schema[COLSTACK_MAX_FIELDS];
+  for (size_t i = 0; i < fields; ++i) schema[i] = record_size / fields;
+  return colstack_init(&stk->colstack, schema, fields);
+}
+static void colstack_adapt_destroy(any_stack_t* stk) { colstack_destroy(&stk->colstack); }
+static int colstack_adapt_push(any_stack_t* stk, void const* val) { return colstack_push(&stk->colstack, val); }
+static void* colstack_adapt_peek(any_stack_t* stk) { return colstack_peek_field(&stk->colstack, 0); }
+static int colstack_adapt_pop(any_stack_t* stk) { return colstack_pop(&stk->colstack); }
+static size_t colstack_adapt_size(any_stack_t const* stk) { return colstack_size(&stk->colstack); }
+
+// The typed stacks take their record size at compile time, so
+// there's one of them per record size.
+#define DEFINE_ADAPTER(name, type)                                            \
+  static int name##_adapt_supports(size_t record_size) {                      \
+    return record_size == sizeof(type);                                       \
+  }                                                                           \
+  static int name##_adapt_init(any_stack_t* stk, size_t record_size) {        \
+    (void) record_size;                                                       \
+    return name##_init(&stk->name);                                           \
+  }                                                                           \
+  static void name##_adapt_destroy(any_stack_t* stk) {                        \
+    name##_destroy(&stk->name);                                               \
+  }                                                                           \
+  static int name##_adapt_push(any_stack_t* stk, void const* val) {           \
+    return name##_push(&stk->name, val);                                      \
+  }                                                                           \
+  static void* name##_adapt_peek(any_stack_t* stk) {                          \
+    return name##_peek(&stk->name);                                           \
+  }                                                                           \
+  static int name##_adapt_pop(any_stack_t* stk) {                             \
+    return name##_pop(&stk->name);                                            \
+  }                                                                           \
+  static size_t name##_adapt_size(any_stack_t const* stk) {                   \
+    return name##_size(&stk->name);                                           \
+  }
+
+DEFINE_ADAPTER(tstack8, rec8_t)
+DEFINE_ADAPTER(tstack64, rec64_t)
+DEFINE_ADAPTER(tstack256, rec256_t)
+
+#define ADAPTER(label, name, depth, supports)                                 \
+  {label, depth, supports, name##_adapt_init, name##_adapt_destroy,           \
+    name##_adapt_push, name##_adapt_peek, name##_adapt_pop, name##_adapt_size}
+
+/*----- Globals -----*/
+
+static stack_ops_t const stacks[] = {
+  ADAPTER("sstack", sstack, SSTACK_SIZE, word_size),
+  ADAPTER("tstack", tstack8, 0, tstack8_adapt_supports),
+  ADAPTER("tstack", tstack64, 0, tstack64_adapt_supports),
+  ADAPTER("tstack", tstack256, 0, tstack256_adapt_supports),
+  ADAPTER("gstack", gstack, 0, any_size),
+  ADAPTER("dstack", dstack, 0, any_size),
+  ADAPTER("colstack", colstack, 0, column_size)
+};
+
+static char const* const workload_names[WORKLOAD_COUNT] = {
+  "push", "pop", "mixed", "peek"
+};
+
+static size_t const record_sizes[] = {8, 64, 256};
+static size_t const depths[] = {16, 1024, 65536};
+
+// Keeps the values we peek at alive past the optimizer.
+static volatile uint64_t sink;
+
+/*----- Function Implementations -----*/
+
+static int any_size(size_t record_size) {
+  return record_size > 0;
+}
+
+static int word_size(size_t record_size) {
+  return record_size == sizeof(int64_t);
+}
+
+static int column_size(size_t record_size) {
+  return record_size && record_size % sizeof(int64_t) == 0;
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compare_double(void const* lhs, void const* rhs) {
+  double a = *(double const*) lhs, b = *(double const*) rhs;
+  return (a > b) - (a < b);
+}
+
+static uint64_t timer_overhead(void) {
+  // The median cost of reading the clock twice, which gets taken
+  // back out of every round, so shallow rounds aren't dominated
+  // by the clock itself.
+  double samples[CALIBRATION_ROUNDS];
+  for (int i = 0; i < CALIBRATION_ROUNDS; ++i) {
+    uint64_t start = now_ns();
+    samples[i] = now_ns() - start;
+  }
+  qsort(samples, CALIBRATION_ROUNDS, sizeof(double), compare_double);
+  return samples[CALIBRATION_ROUNDS / 2];
+}
+
+static int build_script(script_t* script, workload_t workload, size_t depth, prng_t* rng) {
+  // Every round is depth operations long.
+  script->ops = malloc(depth);
+  if (!script->ops) return -1;
+  script->len = depth;
+
+  // Push and pop rounds are one long run from empty to full, or
+  // back. Mixed rounds walk up and down from half full, and peek
+  // rounds mostly read a full stack, pushing and popping now and
+  // then. Either way, the walk never leaves [0, depth].
+  size_t size = 0;
+  switch (workload) {
+    case WORKLOAD_PUSH:
+      script->prefill = 0;
+      memset(script->ops, OP_PUSH, depth);
+      return 0;
+    case WORKLOAD_POP:
+      script->prefill = depth;
+      memset(script->ops, OP_POP, depth);
+      return 0;
+    case WORKLOAD_MIXED:
+      script->prefill = size = depth / 2;
+      for (size_t i = 0; i < depth; ++i) {
+        op_t op = prng_bounded(rng, 2) ? OP_PUSH : OP_POP;
+        if (size == 0) op = OP_PUSH;
+        else if (size == depth) op = OP_POP;
+        size += op == OP_PUSH ? 1 : -1;
+        script->ops[i] = op;
+      }
+      return 0;
+    case WORKLOAD_PEEK:
+    default:
+      script->prefill = size = depth;
+      for (size_t i = 0; i < depth; ++i) {
+        uint64_t roll = prng_bounded(rng, 20);
+        op_t op = roll > 1 ? OP_PEEK : roll ? OP_PUSH : OP_POP;
+        if (op == OP_PUSH && size == depth) op = OP_POP;
+        if (op == OP_POP && size == 0) op = OP_PUSH;
+        if (op != OP_PEEK) size += op == OP_PUSH ? 1 : -1;
+        script->ops[i] = op;
+      }
+      return 0;
+  }
+}
+
+static int refill(stack_ops_t const* ops, any_stack_t* stk, size_t prefill, void const* record) {
+  while (ops->size(stk) < prefill) {
+    if (ops->push(stk, record)) return -1;
+  }
+  while (ops->size(stk) > prefill) ops->pop(stk);
+  return 0;
+}
+
+static int run_script(stack_ops_t const* ops, any_stack_t* stk, script_t const* script, void const* record) {
+  uint64_t sum = 0;
+  int failures = 0;
+  for (size_t i = 0; i < script->len; ++i) {
+    switch (script->ops[i]) {
+      case OP_PUSH:
+        failures |= ops->push(stk, record);
+        break;
+      case OP_POP:
+        failures |= ops->pop(stk);
+        break;
+      default:
+        sum += *(unsigned char*) ops->peek(stk);
+    }
+  }
+  sink += sum;
+  return failures;
+}
+
+static int run_case(stack_ops_t const* ops, script_t const* script, size_t record_size,
+    int64_t rounds, uint64_t overhead, counters_t* ctr, double* samples, result_t* res) {
+  any_stack_t stk;
+  if (ops->init(&stk, record_size)) return -1;
+  char* record = calloc(1, record_size);
+  if (!record) {
+    ops->destroy(&stk);
+    return -1;
+  }
+
+  // Run one round untimed first, so the stack has already grown
+  // to its working size, and we're timing the steady state.
+  int err = refill(ops, &stk, script->prefill, record);
+  if (!err) err = run_script(ops, &stk, script, record);
+
+  counters_reset(ctr);
+  for (int64_t round = 0; round < rounds && !err; ++round) {
+    err = refill(ops, &stk, script->prefill, record);
+    counters_start(ctr);
+    uint64_t start = now_ns();
+    err |= run_script(ops, &stk, script, record);
+    uint64_t elapsed = now_ns() - start;
+    counters_stop(ctr);
+    elapsed = elapsed > overhead ? elapsed - overhead : 0;
+    samples[round] = (double) elapsed / script->len;
+  }
+  free(record);
+  ops->destroy(&stk);
+  if (err) return -1;
+
+  // Summarize the per round samples.
+  double total = 0;
+  for (int64_t round = 0; round < rounds; ++round) total += samples[round];
+  qsort(samples, rounds, sizeof(double), compare_double);
+  double ops_run = (double) rounds * script->len;
+  res->rounds = rounds;
+  res->mean = total / rounds;
+  res->p50 = samples[(rounds - 1) * 50 / 100];
+  res->p90 = samples[(rounds - 1) * 90 / 100];
+  res->p99 = samples[(rounds - 1) * 99 / 100];
+  res->max = samples[rounds - 1];
+  res->instructions = ctr->totals[COUNTER_INSTRUCTIONS] / ops_run;
+  res->cache_misses = ctr->totals[COUNTER_CACHE_MISSES] / ops_run;
+  return 0;
+}
+
+static void print_text(char const* stack, workload_t workload, size_t record_size,
+    size_t depth, result_t const* res, int counted) {
+  printf("stack=%s workload=%s record=%zu depth=%zu mean_ns=%.2f p50_ns=%.2f"
+      " p90_ns=%.2f p99_ns=%.2f max_ns=%.2f", stack, workload_names[workload],
+      record_size, depth, res->mean, res->p50, res->p90, res->p99, res->max);
+  if (counted) printf(" instr_op=%.2f miss_op=%.4f", res->instructions, res->cache_misses);
+  printf("\n");
+}
+
+static void print_json(char const* stack, workload_t workload, size_t record_size,
+    size_t depth, result_t const* res, int counted, int first) {
+  printf("%s\n    {\"stack\": \"%s\", \"workload\": \"%s\", \"record_size\": %zu,"
+      " \"depth\": %zu, \"rounds\": %" PRId64 ", \"ns_per_op\": {\"mean\": %.3f,"
+      " \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}",
+      first ? "" : ",", stack, workload_names[workload], record_size, depth,
+      res->rounds, res->mean, res->p50, res->p90, res->p99, res->max);
+  if (counted) {
+    printf(", \"instructions_per_op\": %.3f, \"cache_misses_per_op\": %.5f}",
+        res->instructions, res->cache_misses);
+  } else {
+    printf(", \"instructions_per_op\": null, \"cache_misses_per_op\": null}");
+  }
+}
+
+static void usage(char const* prog) {
+  fprintf(stderr, "Usage: %s [--json] [--stack name] [ops]\n", prog);
+}
+
+int main(int argc, char** argv) {
+  // Usage: suite [--json] [--stack name] [ops]
+  // ops is roughly how many operations each case times, though
+  // every case times between MIN_ROUNDS and MAX_ROUNDS rounds.
+  int json = 0;
+  char const* only = NULL;
+  int64_t target_ops = DEFAULT_OPS;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--json")) {
+      json = 1;
+    } else if (!strcmp(argv[i], "--stack") && i + 1 < argc) {
+      only = argv[++i];
+    } else if (argv[i][0] != '-' && strtoll(argv[i], NULL, 10) > 0) {
+      target_ops = strtoll(argv[i], NULL, 10);
+    } else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The counters are a bonus. Without them, we still have times.
+  counters_t ctr;
+  if (counters_open(&ctr)) {
+    fprintf(stderr, "Hardware counters unavailable (%s), reporting times only\n", strerror(errno));
+  }
+  uint64_t overhead = timer_overhead();
+
+  double* samples = malloc(sizeof(double) * MAX_ROUNDS);
+  if (!samples) {
+    perror("malloc");
+    return EXIT_FAILURE;
+  }
+
+  if (json) {
+    printf("{\n  \"timer_overhead_ns\": %" PRIu64 ",\n  \"counters\": %s,\n  \"results\": [",
+        overhead, ctr.available ? "true" : "false");
+  }
+
+  // Every workload, at every depth and record size, for every
+  // stack that can hold it.
+  prng_t rng;
+  prng_seed(&rng, SEED);
+  int first = 1, err = 0;
+  size_t num_stacks = sizeof(stacks) / sizeof(stacks[0]);
+  size_t num_sizes = sizeof(record_sizes) / sizeof(record_sizes[0]);
+  size_t num_depths = sizeof(depths) / sizeof(depths[0]);
+  for (int workload = 0; workload < WORKLOAD_COUNT && !err; ++workload) {
+    for (size_t d = 0; d < num_depths && !err; ++d) {
+      script_t script;
+      if (build_script(&script, workload, depths[d], &rng)) {
+        perror("malloc");
+        err = 1;
+        break;
+      }
+      int64_t rounds = target_ops / depths[d];
+      if (rounds < MIN_ROUNDS) rounds = MIN_ROUNDS;
+      if (rounds > MAX_ROUNDS) rounds = MAX_ROUNDS;
+
+      for (size_t r = 0; r < num_sizes && !err; ++r) {
+        for (size_t s = 0; s < num_stacks && !err; ++s) {
+          stack_ops_t const* ops = &stacks[s];
+          if (only && strcmp(only, ops->name)) continue;
+          if (!ops->supports(record_sizes[r])) continue;
+          if (ops->max_depth && depths[d] > ops->max_depth) continue;
+
+          result_t res;
+          if (run_case(ops, &script, record_sizes[r], rounds, overhead, &ctr, samples, &res)) {
+            fprintf(stderr, "%s failed: %s\n", ops->name, strerror(errno));
+            err = 1;
+            break;
+          }
+          if (json) print_json(ops->name, workload, record_sizes[r], depths[d], &res, ctr.available, first);
+          else print_text(ops->name, workload, record_sizes[r], depths[d], &res, ctr.available);
+          first = 0;
+        }
+      }
+      free(script.ops);
+    }
+  }
+  if (json) printf("\n  ]\n}\n");
+
+  free(samples);
+  counters_close(&ctr);
+  return err ? EXIT_FAILURE : EXIT_SUCCESS;
+}
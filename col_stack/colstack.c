@@ -0,0 +1,222 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "colstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define COLSTACK_INIT_CAPACITY            (8)
+
+/*----- Function Implementations -----*/
+
+inline static void sanity_check(colstack_t const* stk) {
+  // Make sure our basic invariants hold.
+  assert(stk && stk->pos < stk->capacity && stk->pos >= COLSTACK_BASE && stk->capacity);
+  assert(stk->num_fields && stk->num_fields <= COLSTACK_MAX_FIELDS);
+}
+
+inline static void* calc_ptr(colstack_t* stk, size_t field, int64_t pos) {
+  return (char*) stk->columns[field] + ((size_t) pos * stk->field_sizes[field]);
+}
+
+inline static void copy_field(void* dst, void const* src, size_t size) {
+  // Most fields are scalars, and a fixed size copy turns into
+  // a single load and store instead of a call.
+  switch (size) {
+    case 1: memcpy(dst, src, 1); break;
+    case 2: memcpy(dst, src, 2); break;
+    case 4: memcpy(dst, src, 4); break;
+    case 8: memcpy(dst, src, 8); break;
+    default: memcpy(dst, src, size);
+  }
+}
+
+static void free_columns(void** columns, size_t count) {
+  for (size_t i = 0; i < count; ++i) free(columns[i]);
+}
+
+static int alloc_columns(colstack_t* stk, void** columns, int64_t capacity) {
+  // Allocate every column, or none of them.
+  for (size_t i = 0; i < stk->num_fields; ++i) {
+    if (posix_memalign(&columns[i], COLSTACK_ALIGN, (size_t) capacity * stk->field_sizes[i])) {
+      free_columns(columns, i);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int extend_stack(colstack_t* stk) {
+  // Double our capacity, as long as the widest field,
+  // and so every column, can still be addressed.
+  int64_t target = stk->capacity * 2;
+  if (stk->capacity > INT64_MAX / 2 || (uint64_t) target > SIZE_MAX / stk->record_size) return -1;
+
+  // Allocate new columns and copy each one over.
+  // realloc doesn't know about alignment, so we move them
+  // ourselves, and only swap them in once all of them succeed.
+  void* columns[COLSTACK_MAX_FIELDS];
+  if (alloc_columns(stk, columns, target)) return -1;
+  for (size_t i = 0; i < stk->num_fields; ++i) {
+    memcpy(columns[i], stk->columns[i], colstack_size(stk) * stk->field_sizes[i]);
+  }
+  free_columns(stk->columns, stk->num_fields);
+  memcpy(stk->columns, columns, sizeof(void*) * stk->num_fields);
+  stk->capacity = target;
+  return 0;
+}
+
+int colstack_init(colstack_t* stk, size_t const* field_sizes, size_t num_fields) {
+  // Check error conditions.
+  if (!stk || !field_sizes || !num_fields || num_fields > COLSTACK_MAX_FIELDS) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Lay the schema out, working out where each field sits
+  // in a packed record.
+  stk->record_size = 0;
+  for (size_t i = 0; i < num_fields; ++i) {
+    if (!field_sizes[i] || field_sizes[i] > SIZE_MAX - stk->record_size) {
+      errno = EINVAL;
+      return -1;
+    }
+    stk->field_sizes[i] = field_sizes[i];
+    stk->field_offsets[i] = stk->record_size;
+    stk->record_size += field_sizes[i];
+  }
+  stk->num_fields = num_fields;
+  stk->pos = COLSTACK_BASE;
+  stk->capacity = COLSTACK_INIT_CAPACITY;
+
+  // We need to check if allocation failed, as we could otherwise
+  // leak a partially initialized stack.
+  if (alloc_columns(stk, stk->columns, stk->capacity)) {
+    errno = ENOMEM;
+    return -1;
+  }
+  errno = 0;
+  return 0;
+}
+
+void colstack_destroy(colstack_t* stk) {
+  sanity_check(stk);
+  free_columns(stk->columns, stk->num_fields);
+}
+
+int colstack_push_fields(colstack_t* stk, void const* const* fields) {
+  // Check error conditions.
+  sanity_check(stk);
+  int64_t target = stk->pos + 1;
+  if (!fields) {
+    errno = EINVAL;
+    return -1;
+  } else if (target == stk->capacity && extend_stack(stk)) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // Scatter the fields out to their columns.
+  for (size_t i = 0; i < stk->num_fields; ++i) {
+    copy_field(calc_ptr(stk, i, target), fields[i], stk->field_sizes[i]);
+  }
+
+  // Publish and return.
+  ++stk->pos;
+  errno = 0;
+  return 0;
+}
+
+int colstack_push(colstack_t* stk, void const* record) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (!record) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Point at each field in the packed record.
+  void const* fields[COLSTACK_MAX_FIELDS];
+  for (size_t i = 0; i < stk->num_fields; ++i) {
+    fields[i] = (char const*) record + stk->field_offsets[i];
+  }
+  return colstack_push_fields(stk, fields);
+}
+
+int colstack_peek(colstack_t* stk, void* out) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (!out) {
+    errno = EINVAL;
+    return -1;
+  } else if (stk->pos == COLSTACK_BASE) {
+    errno = ENOENT;
+    return -1;
+  }
+
+  // Gather the fields back into a packed record.
+  for (size_t i = 0; i < stk->num_fields; ++i) {
+    copy_field((char*) out + stk->field_offsets[i], calc_ptr(stk, i, stk->pos), stk->field_sizes[i]);
+  }
+  errno = 0;
+  return 0;
+}
+
+void* colstack_peek_field(colstack_t* stk, size_t field) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (field >= stk->num_fields) {
+    errno = EINVAL;
+    return NULL;
+  } else if (stk->pos == COLSTACK_BASE) {
+    errno = ENOENT;
+    return NULL;
+  }
+
+  errno = 0;
+  return calc_ptr(stk, field, stk->pos);
+}
+
+void* colstack_column(colstack_t* stk, size_t field) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (field >= stk->num_fields) {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  errno = 0;
+  return stk->columns[field];
+}
+
+int colstack_pop(colstack_t* stk) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (stk->pos == COLSTACK_BASE) {
+    errno = ENOENT;
+    return -1;
+  }
+
+  // Publish and return.
+  --stk->pos;
+  errno = 0;
+  return 0;
+}
+
+size_t colstack_size(colstack_t const* stk) {
+  sanity_check(stk);
+  return stk->pos + 1;
+}
+
+size_t colstack_capacity(colstack_t const* stk) {
+  sanity_check(stk);
+  return stk->capacity;
+}
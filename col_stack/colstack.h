@@ -0,0 +1,59 @@
+#ifndef COLSTACK_H
+#define COLSTACK_H
+
+/*----- System Includes -----*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+/*----- Numerical Constants -----*/
+
+#define COLSTACK_BASE          (-1)
+#define COLSTACK_MAX_FIELDS    (16)
+
+// Every column starts on a cache line, so scans can use
+// aligned vector loads.
+#define COLSTACK_ALIGN         (64)
+
+/*----- Type Declarations -----*/
+
+// A stack of records, stored a column per field rather than
+// a record at a time.
+// The schema is the size of each field, in order. Whole records
+// go in and out packed, each field straight after the last with
+// no padding, and field i of record pos lives at
+// columns[i] + pos * field_sizes[i].
+typedef struct columnar_stack {
+  int64_t pos, capacity;
+  size_t num_fields, record_size;
+  size_t field_sizes[COLSTACK_MAX_FIELDS];
+  size_t field_offsets[COLSTACK_MAX_FIELDS];
+  void* columns[COLSTACK_MAX_FIELDS];
+} colstack_t;
+
+/*----- Function Declarations -----*/
+
+// Lifecycle functions
+int colstack_init(colstack_t* stk, size_t const* field_sizes, size_t num_fields);
+void colstack_destroy(colstack_t* stk);
+
+// Stack operations
+// colstack_peek copies the top record out, packed, since it
+// doesn't live anywhere in one piece.
+int colstack_push(colstack_t* stk, void const* record);
+int colstack_peek(colstack_t* stk, void* out);
+int colstack_pop(colstack_t* stk);
+size_t colstack_size(colstack_t const* stk);
+size_t colstack_capacity(colstack_t const* stk);
+
+// Field operations
+// colstack_push_fields takes a pointer to each field's value.
+// colstack_peek_field points at one field of the top record.
+// colstack_column points at a whole column, colstack_size values
+// ordered bottom to top, and is valid until the next push.
+int colstack_push_fields(colstack_t* stk, void const* const* fields);
+void* colstack_peek_field(colstack_t* stk, size_t field);
+void* colstack_column(colstack_t* stk, size_t field);
+
+#endif
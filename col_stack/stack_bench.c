@@ -0,0 +1,128 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "../dyn_stack/dstack.h"
+#include "colstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_RECORDS       (1000000LL)
+#define SCANS                 (100)
+#define PAYLOAD               (48)
+
+/*----- Type Declarations -----*/
+
+// A typical wide record, where a scan only cares about one
+// small field and the rest is along for the ride.
+typedef struct record {
+  uint64_t key;
+  uint32_t len;
+  uint32_t flags;
+  char payload[PAYLOAD];
+} record_t;
+
+/*----- Globals -----*/
+
+static size_t const schema[] = {
+  sizeof(uint64_t), sizeof(uint32_t), sizeof(uint32_t), PAYLOAD
+};
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static record_t make_record(int64_t i) {
+  record_t rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.key = i;
+  rec.len = i & 0xFFF;
+  rec.flags = i & 3;
+  return rec;
+}
+
+static uint64_t scan_rows(dstack_t* stk, int64_t records) {
+  // Every len is a whole record apart, so each cache line
+  // we pull in holds a single useful value.
+  record_t const* rows = dstack_peek_n(stk, records);
+  uint64_t sum = 0;
+  for (int64_t i = 0; i < records; ++i) sum += rows[i].len;
+  return sum;
+}
+
+static uint64_t scan_column(colstack_t* stk, int64_t records) {
+  // Every len is packed next to the last, which the compiler
+  // can vectorize.
+  uint32_t const* lens = colstack_column(stk, 1);
+  uint64_t sum = 0;
+  for (int64_t i = 0; i < records; ++i) sum += lens[i];
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  // Usage: stack_bench [records]
+  int64_t records = DEFAULT_RECORDS;
+  if (argc >= 2) records = strtoll(argv[1], NULL, 10);
+  if (records <= 0) {
+    fprintf(stderr, "Usage: %s [records]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // Fill both stacks with the same records.
+  dstack_t rows;
+  colstack_t cols;
+  if (dstack_init(&rows, sizeof(record_t), NULL) || colstack_init(&cols, schema, 4)) {
+    perror("init");
+    return EXIT_FAILURE;
+  }
+  double start = now();
+  for (int64_t i = 0; i < records; ++i) {
+    record_t rec = make_record(i);
+    dstack_push(&rows, &rec);
+  }
+  double row_push = now() - start;
+  start = now();
+  for (int64_t i = 0; i < records; ++i) {
+    record_t rec = make_record(i);
+    colstack_push(&cols, &rec);
+  }
+  double col_push = now() - start;
+
+  // Scan the len field of every record, a few times over.
+  uint64_t row_sum = 0, col_sum = 0;
+  start = now();
+  for (int scan = 0; scan < SCANS; ++scan) row_sum += scan_rows(&rows, records);
+  double row_scan = now() - start;
+  start = now();
+  for (int scan = 0; scan < SCANS; ++scan) col_sum += scan_column(&cols, records);
+  double col_scan = now() - start;
+  if (row_sum != col_sum) {
+    fprintf(stderr, "Scans disagree: %llu vs %llu\n",
+        (unsigned long long) row_sum, (unsigned long long) col_sum);
+    return EXIT_FAILURE;
+  }
+
+  double scanned = (double) records * SCANS;
+  printf("%lld records of %zu bytes, %d scans of one 4 byte field\n",
+      (long long) records, sizeof(record_t), SCANS);
+  printf("dstack:   push %.2f ns/record, scan %.3f ns/record\n",
+      row_push * 1e9 / records, row_scan * 1e9 / scanned);
+  printf("colstack: push %.2f ns/record, scan %.3f ns/record\n",
+      col_push * 1e9 / records, col_scan * 1e9 / scanned);
+
+  dstack_destroy(&rows);
+  colstack_destroy(&cols);
+  return 0;
+}
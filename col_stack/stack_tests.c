@@ -0,0 +1,149 @@
+/*----- System Includes -----*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "colstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define NUM_RECORDS         (1000)
+#define NUM_FIELDS          (4)
+
+/*----- Type Declarations -----*/
+
+// Laid out without padding, so it matches the packed
+// records colstack_push and colstack_peek expect.
+typedef struct record {
+  uint64_t key;
+  uint32_t len;
+  uint16_t tag;
+  uint8_t flag;
+  uint8_t spare;
+} record_t;
+
+/*----- Globals -----*/
+
+static size_t const schema[NUM_FIELDS] = {
+  sizeof(uint64_t), sizeof(uint32_t), sizeof(uint16_t), sizeof(uint8_t) * 2
+};
+
+/*----- Function Implementations -----*/
+
+static record_t make_record(int i) {
+  record_t rec = {0};
+  rec.key = (uint64_t) i * 0x9E3779B97F4A7C15ULL;
+  rec.len = i * 3;
+  rec.tag = i & 0xFFFF;
+  rec.flag = i & 1;
+  rec.spare = i % 7;
+  return rec;
+}
+
+static void test_init() {
+  colstack_t stk;
+  size_t empty[2] = {8, 0};
+  size_t wide[COLSTACK_MAX_FIELDS + 1];
+  for (int i = 0; i < COLSTACK_MAX_FIELDS + 1; ++i) wide[i] = 1;
+
+  // Bad schemas are rejected up front.
+  assert(colstack_init(NULL, schema, NUM_FIELDS) == -1 && errno == EINVAL);
+  assert(colstack_init(&stk, NULL, NUM_FIELDS) == -1 && errno == EINVAL);
+  assert(colstack_init(&stk, schema, 0) == -1 && errno == EINVAL);
+  assert(colstack_init(&stk, empty, 2) == -1 && errno == EINVAL);
+  assert(colstack_init(&stk, wide, COLSTACK_MAX_FIELDS + 1) == -1 && errno == EINVAL);
+
+  // The widest schema we support works.
+  assert(colstack_init(&stk, wide, COLSTACK_MAX_FIELDS) == 0);
+  assert(stk.record_size == COLSTACK_MAX_FIELDS);
+  colstack_destroy(&stk);
+
+  // And so does ours, with fields laid out back to back.
+  assert(colstack_init(&stk, schema, NUM_FIELDS) == 0);
+  assert(stk.record_size == sizeof(record_t));
+  assert(stk.field_offsets[1] == 8 && stk.field_offsets[2] == 12 && stk.field_offsets[3] == 14);
+  assert(colstack_size(&stk) == 0);
+  colstack_destroy(&stk);
+}
+
+static void test_records() {
+  colstack_t stk;
+  record_t rec;
+  assert(colstack_init(&stk, schema, NUM_FIELDS) == 0);
+
+  // An empty stack has nothing to look at.
+  assert(colstack_peek(&stk, &rec) == -1 && errno == ENOENT);
+  assert(colstack_pop(&stk) == -1 && errno == ENOENT);
+  assert(!colstack_peek_field(&stk, 0) && errno == ENOENT);
+  assert(colstack_push(&stk, NULL) == -1 && errno == EINVAL);
+  assert(colstack_peek(&stk, NULL) == -1 && errno == EINVAL);
+
+  // Push enough records to grow the stack several times over.
+  for (int i = 0; i < NUM_RECORDS; ++i) {
+    rec = make_record(i);
+    assert(colstack_push(&stk, &rec) == 0);
+  }
+  assert(colstack_size(&stk) == NUM_RECORDS);
+  assert(colstack_capacity(&stk) > NUM_RECORDS);
+
+  // Every record comes back out whole, in reverse order.
+  for (int i = NUM_RECORDS - 1; i >= 0; --i) {
+    record_t expected = make_record(i);
+    assert(colstack_peek(&stk, &rec) == 0);
+    assert(!memcmp(&rec, &expected, sizeof(record_t)));
+    assert(*(uint32_t*) colstack_peek_field(&stk, 1) == expected.len);
+    assert(colstack_pop(&stk) == 0);
+  }
+  assert(colstack_size(&stk) == 0);
+  colstack_destroy(&stk);
+}
+
+static void test_fields() {
+  colstack_t stk;
+  assert(colstack_init(&stk, schema, NUM_FIELDS) == 0);
+
+  // Push field by field, from values that live apart.
+  for (int i = 0; i < NUM_RECORDS; ++i) {
+    record_t rec = make_record(i);
+    void const* fields[NUM_FIELDS] = {&rec.key, &rec.len, &rec.tag, &rec.flag};
+    assert(colstack_push_fields(&stk, fields) == 0);
+  }
+  assert(colstack_push_fields(&stk, NULL) == -1 && errno == EINVAL);
+  assert(!colstack_peek_field(&stk, NUM_FIELDS) && errno == EINVAL);
+  assert(!colstack_column(&stk, NUM_FIELDS) && errno == EINVAL);
+
+  // Each column is aligned, and holds one field for every
+  // record, bottom to top.
+  uint64_t* keys = colstack_column(&stk, 0);
+  uint32_t* lens = colstack_column(&stk, 1);
+  uint8_t* bytes = colstack_column(&stk, 3);
+  assert((uintptr_t) keys % COLSTACK_ALIGN == 0);
+  assert((uintptr_t) lens % COLSTACK_ALIGN == 0);
+  uint64_t total = 0;
+  for (int i = 0; i < NUM_RECORDS; ++i) {
+    record_t expected = make_record(i);
+    assert(keys[i] == expected.key);
+    assert(lens[i] == expected.len);
+    assert(bytes[i * 2] == expected.flag && bytes[i * 2 + 1] == expected.spare);
+    total += lens[i];
+  }
+  assert(total == 3ULL * NUM_RECORDS * (NUM_RECORDS - 1) / 2);
+
+  // Popping shrinks the view, but leaves what's under it alone.
+  assert(colstack_pop(&stk) == 0);
+  assert(colstack_size(&stk) == NUM_RECORDS - 1);
+  assert(*(uint64_t*) colstack_peek_field(&stk, 0) == make_record(NUM_RECORDS - 2).key);
+  assert(colstack_column(&stk, 0) == keys);
+  colstack_destroy(&stk);
+}
+
+int main() {
+  test_init();
+  test_records();
+  test_fields();
+  return 0;
+}
@@ -1,6 +1,27 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <time.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+
+#include "../arena/arena.h"
+#include "../prng/prng.h"
+
+// The threaded mode gives every worker a contiguous slice of the
+// strings, its own generator stream, and its own pair of arenas, so
+// workers never touch the same allocator or cache lines of string data.
+typedef struct worker {
+  char** strs;
+  char** dups;
+  size_t begin, end, len;
+  prng_t rng;
+  arena_t str_arena, dup_arena;
+  int failed;
+} worker_t;
+
+typedef void* (*phase_t)(void*);
 
 size_t arrlen(void* arr) {
   void** curr = (void**) arr;
@@ -8,27 +29,21 @@ size_t arrlen(void* arr) {
   return curr - (void**) arr;
 }
 
-char* rand_string(size_t len) {
-  // Our character set to pull from
-  static char const* alpha = "abcdefghijklmnopqrstuvwxyz";
-
+char* rand_string(prng_t* rng, size_t len) {
   // Get memory for our string.
   char* str = (char*) malloc(sizeof(char) * (len + 1));
 
   // Write in our random characters.
-  // XXX: The function rand is a TERRIBLE random number generator
-  // Don't write this code in production
-  char* curr = str;
-  while (curr - str < len) {
-    *curr++ = alpha[rand() % 26];
-  }
+  // Unlike rand() % 26, this isn't biased towards the start of
+  // the alphabet, and the generator state is ours alone.
+  prng_alpha(rng, str, len);
 
   // Terminate our string and return.
   str[len] = '\0';
   return str;
 }
 
-char** rand_strings(size_t num, size_t len) {
+char** rand_strings(prng_t* rng, size_t num, size_t len) {
   // Allocate an array of character pointers
   // We allocate one more than we were asked for so that
   // we can null terminate the array.
@@ -40,7 +55,7 @@ char** rand_strings(size_t num, size_t len) {
   // We don't have to touch the last element in the array
   // because calloc already initialized it to NULL.
   for (size_t i = 0; i < num; ++i) {
-    strs[i] = rand_string(len);
+    strs[i] = rand_string(rng, len);
   }
   return strs;
 }
@@ -72,27 +87,200 @@ void destroy_strs(char** strs) {
   free(strs);
 }
 
+void* rand_strings_worker(void* arg) {
+  // Strings are packed back to back in the arena, there's
+  // no need to align character data.
+  worker_t* work = (worker_t*) arg;
+  if (work->failed) return NULL;
+  for (size_t i = work->begin; i < work->end; ++i) {
+    char* str = arena_alloc_aligned(&work->str_arena, work->len + 1, 1);
+    if (!str) {
+      work->failed = 1;
+      return NULL;
+    }
+    prng_alpha(&work->rng, str, work->len);
+    str[work->len] = '\0';
+    work->strs[i] = str;
+  }
+  return NULL;
+}
+
+void* dup_strs_worker(void* arg) {
+  // Unlike dup_str, this leaves room for the terminator.
+  worker_t* work = (worker_t*) arg;
+  for (size_t i = work->begin; i < work->end; ++i) {
+    size_t len = strlen(work->strs[i]) + 1;
+    char* dup = arena_alloc_aligned(&work->dup_arena, len, 1);
+    if (!dup) {
+      work->failed = 1;
+      return NULL;
+    }
+    work->dups[i] = memcpy(dup, work->strs[i], len);
+  }
+  return NULL;
+}
+
+void* destroy_strs_worker(void* arg) {
+  // Every string goes back at once with its arena.
+  worker_t* work = (worker_t*) arg;
+  arena_destroy(&work->dup_arena);
+  arena_destroy(&work->str_arena);
+  return NULL;
+}
+
+double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+double run_phase(worker_t* workers, size_t num_threads, phase_t phase) {
+  // Fan the phase out to every worker and wait for them all.
+  pthread_t* threads = (pthread_t*) malloc(sizeof(pthread_t) * num_threads);
+  if (!threads) return -1;
+  double start = now();
+  size_t started = 0;
+  int err = 0;
+  for (; started < num_threads; ++started) {
+    err = pthread_create(&threads[started], NULL, phase, &workers[started]);
+    if (err) break;
+  }
+
+  // Only the threads that actually started can be joined.
+  for (size_t i = 0; i < started; ++i) pthread_join(threads[i], NULL);
+  double elapsed = now() - start;
+  free(threads);
+  if (err) {
+    fprintf(stderr, "pthread_create: %s\n", strerror(err));
+    errno = err;
+    return -1;
+  }
+
+  // Any worker failing fails the phase. Workers only fail
+  // when they run out of memory.
+  for (size_t i = 0; i < num_threads; ++i) {
+    if (workers[i].failed) {
+      errno = ENOMEM;
+      return -1;
+    }
+  }
+  return elapsed;
+}
+
+int run_threaded(uint64_t seed, size_t num_strs, size_t str_len, size_t num_threads, double* times) {
+  // The pointer arrays are shared, each worker fills in its own slice.
+  char** strs = (char**) calloc(num_strs + 1, sizeof(char*));
+  char** dups = (char**) calloc(num_strs + 1, sizeof(char*));
+  worker_t* workers = (worker_t*) calloc(num_threads, sizeof(worker_t));
+  if (!strs || !dups || !workers) {
+    free(workers);
+    free(dups);
+    free(strs);
+    return -1;
+  }
+
+  // Hand out slices, streams and arenas.
+  size_t share = num_strs / num_threads, extra = num_strs % num_threads, begin = 0;
+  for (size_t i = 0; i < num_threads; ++i) {
+    worker_t* work = &workers[i];
+    work->strs = strs;
+    work->dups = dups;
+    work->begin = begin;
+    work->end = begin += share + (i < extra);
+    work->len = str_len;
+    prng_stream(&work->rng, seed, i);
+    if (arena_init(&work->str_arena, ARENA_MALLOC, 0)) work->failed = 1;
+    if (arena_init(&work->dup_arena, ARENA_MALLOC, 0)) work->failed = 1;
+  }
+
+  // Generate, duplicate, and tear down, timing each phase.
+  // Hold onto the first error, since tearing down can
+  // overwrite errno.
+  int err = 0;
+  times[0] = run_phase(workers, num_threads, rand_strings_worker);
+  if (times[0] < 0) err = errno;
+  times[1] = err ? -1 : run_phase(workers, num_threads, dup_strs_worker);
+  if (!err && times[1] < 0) err = errno;
+  times[2] = run_phase(workers, num_threads, destroy_strs_worker);
+  if (times[2] < 0) {
+    // Some workers may never have gotten a thread to tear down
+    // their arenas, so do it for them here. Destroying an arena
+    // leaves it empty, so the ones that did aren't freed twice.
+    if (!err) err = errno;
+    for (size_t i = 0; i < num_threads; ++i) destroy_strs_worker(&workers[i]);
+  }
+  free(workers);
+  free(dups);
+  free(strs);
+  errno = err;
+  return err ? -1 : 0;
+}
+
+int parse_size(char const* str, size_t* out) {
+  // strtoull tells us where it stopped, unlike atoi, so we can
+  // reject anything that isn't entirely a number.
+  char* end;
+  if (*str < '0' || *str > '9') return -1;
+  *out = strtoull(str, &end, 10);
+  return *end ? -1 : 0;
+}
+
 int main(int argc, char** argv) {
+  // If the user tells us how many strings to use,
+  // and what their length should be, use it.
+  // --threads N switches over to the parallel pipeline.
+  size_t num_strs = 8, str_len = 8, num_threads = 0;
+  size_t* positional[] = {&num_strs, &str_len};
+  size_t num_positional = 0;
+  for (int i = 1; i < argc; ++i) {
+    int bad;
+    if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+      bad = parse_size(argv[++i], &num_threads) || !num_threads;
+    } else if (num_positional < 2) {
+      bad = parse_size(argv[i], positional[num_positional++]);
+    } else {
+      bad = 1;
+    }
+    if (bad) {
+      fprintf(stderr, "Usage: %s [--threads N] [num_strs] [str_len]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
   // Seed our random number generator
   // so it doesn't always generate the same strings.
-  srand(time(NULL));
+  uint64_t seed = time(NULL);
+  double times[3];
+  if (num_threads) {
+    if (run_threaded(seed, num_strs, str_len, num_threads, times)) {
+      perror("run_threaded");
+      return EXIT_FAILURE;
+    }
+  } else {
+    prng_t rng;
+    prng_seed(&rng, seed);
 
-  // If the user tells us how many strings to use,
-  // and what their length should be, use it.
-  // atoi is another function that's easy to use
-  // but bad. Don't use it in production.
-  size_t num_strs = 8, str_len = 8;
-  if (argc >= 2) num_strs = atoi(argv[1]);
-  if (argc >= 3) str_len = atoi(argv[2]);
+    // Create our strings.
+    double start = now();
+    char** strs = rand_strings(&rng, num_strs, str_len);
+    times[0] = now() - start;
 
-  // Create our strings.
-  char** strs = rand_strings(num_strs, str_len);
+    // Copy them for whatever reason.
+    start = now();
+    char** dups = dup_strs(strs);
+    times[1] = now() - start;
 
-  // Copy them for whatever reason.
-  char** dups = dup_strs(strs);
+    // Clean up.
+    start = now();
+    destroy_strs(dups);
+    destroy_strs(strs);
+    times[2] = now() - start;
+  }
 
-  // Clean up and exit.
-  destroy_strs(dups);
-  destroy_strs(strs);
+  // Report how long each phase took.
+  char const* phases[] = {"generate", "duplicate", "destroy"};
+  for (int i = 0; i < 3; ++i) {
+    printf("%-10s %10.4f s %14.0f strings/s\n", phases[i], times[i], num_strs / times[i]);
+  }
   return 0;
 }
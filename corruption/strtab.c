@@ -0,0 +1,115 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "strtab.h"
+
+/*----- Function Implementations -----*/
+
+inline static void sanity_check(strtab_t const* tab) {
+  assert(tab->count == 0 || tab->offsets);
+  assert(tab->blob || !tab->bytes);
+}
+
+inline static size_t index_bytes(size_t count) {
+  return count * sizeof(size_t);
+}
+
+int strtab_init(strtab_t* tab, size_t count, size_t bytes, arena_t* arena) {
+  // Check error conditions.
+  if (count > SIZE_MAX / sizeof(size_t) || bytes > SIZE_MAX - index_bytes(count)) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // One allocation for the index and the blob both.
+  size_t total = index_bytes(count) + bytes;
+  void* storage = arena ? arena_alloc(arena, total) : malloc(total ? total : 1);
+  if (!storage) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  tab->count = count;
+  tab->bytes = bytes;
+  tab->offsets = (size_t*) storage;
+  tab->blob = (char*) storage + index_bytes(count);
+  tab->arena = arena;
+  errno = 0;
+  return 0;
+}
+
+int strtab_rand(strtab_t* tab, size_t count, size_t len, prng_t* rng, arena_t* arena) {
+  // Every string is the same length, so the blob is easy to size.
+  if (len == SIZE_MAX || count > SIZE_MAX / (len + 1)) {
+    errno = ENOMEM;
+    return -1;
+  }
+  if (strtab_init(tab, count, count * (len + 1), arena)) return -1;
+
+  // Fill the whole blob in one pass, then go back and drop in
+  // the terminators and offsets.
+  prng_alpha(rng, tab->blob, tab->bytes);
+  for (size_t i = 0; i < count; ++i) {
+    tab->offsets[i] = i * (len + 1);
+    tab->blob[tab->offsets[i] + len] = '\0';
+  }
+  return 0;
+}
+
+int strtab_from(strtab_t* tab, char* const* strs, arena_t* arena) {
+  // Work out how much space we need.
+  size_t count = 0, bytes = 0;
+  for (char* const* curr = strs; *curr; ++curr, ++count) bytes += strlen(*curr) + 1;
+  if (strtab_init(tab, count, bytes, arena)) return -1;
+
+  // Pack each string in after the last.
+  size_t offset = 0;
+  for (size_t i = 0; i < count; ++i) {
+    size_t len = strlen(strs[i]) + 1;
+    memcpy(tab->blob + offset, strs[i], len);
+    tab->offsets[i] = offset;
+    offset += len;
+  }
+  return 0;
+}
+
+int strtab_dup(strtab_t* dst, strtab_t const* src, arena_t* arena) {
+  // Check error conditions.
+  sanity_check(src);
+  if (strtab_init(dst, src->count, src->bytes, arena)) return -1;
+
+  // The index and the blob are contiguous, and the offsets are
+  // relative, so the whole table comes across in one copy.
+  memcpy(dst->offsets, src->offsets, index_bytes(src->count) + src->bytes);
+  return 0;
+}
+
+void strtab_destroy(strtab_t* tab) {
+  // Arena storage goes back with the arena.
+  sanity_check(tab);
+  if (!tab->arena) free(tab->offsets);
+  memset(tab, 0, sizeof(strtab_t));
+}
+
+char* strtab_get(strtab_t const* tab, size_t idx) {
+  // Check error conditions.
+  sanity_check(tab);
+  if (idx >= tab->count) {
+    errno = ERANGE;
+    return NULL;
+  }
+
+  errno = 0;
+  return tab->blob + tab->offsets[idx];
+}
+
+size_t strtab_count(strtab_t const* tab) {
+  sanity_check(tab);
+  return tab->count;
+}
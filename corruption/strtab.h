@@ -0,0 +1,45 @@
+#ifndef STRTAB_H
+#define STRTAB_H
+
+/*----- System Includes -----*/
+
+#include <errno.h>
+#include <stddef.h>
+
+/*----- Project Includes -----*/
+
+#include "../arena/arena.h"
+#include "../prng/prng.h"
+
+/*----- Type Declarations -----*/
+
+// A batch of strings packed into one allocation.
+// The offset index sits at the front of the allocation, followed by
+// a blob holding every string and its terminator back to back.
+// Offsets are relative to the blob, so a table can be copied with a
+// single memcpy and stays valid wherever it lands.
+// If arena is set, the storage came from it, and is released with it.
+typedef struct strtab {
+  size_t count, bytes;
+  size_t* offsets;
+  char* blob;
+  arena_t* arena;
+} strtab_t;
+
+/*----- Function Declarations -----*/
+
+// Lifecycle functions
+// All of these take an optional arena to allocate from, or NULL
+// to use malloc. strtab_init reserves storage for count strings
+// totalling bytes, terminators included, for the caller to fill in.
+int strtab_init(strtab_t* tab, size_t count, size_t bytes, arena_t* arena);
+int strtab_rand(strtab_t* tab, size_t count, size_t len, prng_t* rng, arena_t* arena);
+int strtab_from(strtab_t* tab, char* const* strs, arena_t* arena);
+int strtab_dup(strtab_t* dst, strtab_t const* src, arena_t* arena);
+void strtab_destroy(strtab_t* tab);
+
+// Table operations
+char* strtab_get(strtab_t const* tab, size_t idx);
+size_t strtab_count(strtab_t const* tab);
+
+#endif
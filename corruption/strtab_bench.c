@@ -0,0 +1,115 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "strtab.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_STRINGS       (1000000)
+#define DEFAULT_LEN           (8)
+#define SEED                  (42)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// The per-string path from bug.c, minus its deliberate bug.
+static char** rand_strings(prng_t* rng, size_t num, size_t len) {
+  char** strs = (char**) calloc(num + 1, sizeof(char*));
+  if (!strs) return NULL;
+  for (size_t i = 0; i < num; ++i) {
+    char* str = (char*) malloc(len + 1);
+    if (!str) exit(EXIT_FAILURE);
+    prng_alpha(rng, str, len);
+    str[len] = '\0';
+    strs[i] = str;
+  }
+  return strs;
+}
+
+static char** dup_strs(char** strs, size_t num) {
+  char** dups = (char**) calloc(num + 1, sizeof(char*));
+  if (!dups) return NULL;
+  for (size_t i = 0; i < num; ++i) {
+    size_t len = strlen(strs[i]) + 1;
+    dups[i] = (char*) malloc(len);
+    if (!dups[i]) exit(EXIT_FAILURE);
+    memcpy(dups[i], strs[i], len);
+  }
+  return dups;
+}
+
+static void destroy_strs(char** strs) {
+  for (char** curr = strs; *curr; ++curr) free(*curr);
+  free(strs);
+}
+
+static void report(char const* name, double gen, double dup, double destroy) {
+  printf("%-12s %10.4f %10.4f %10.4f %10.4f\n", name, gen, dup, destroy, gen + dup + destroy);
+}
+
+int main(int argc, char** argv) {
+  // Usage: strtab_bench [strings] [length]
+  size_t num = DEFAULT_STRINGS, len = DEFAULT_LEN;
+  if (argc >= 2) num = strtoull(argv[1], NULL, 10);
+  if (argc >= 3) len = strtoull(argv[2], NULL, 10);
+  printf("%zu strings of length %zu, seconds per phase\n", num, len);
+  printf("%-12s %10s %10s %10s %10s\n", "path", "generate", "duplicate", "destroy", "total");
+
+  // Per-string allocations.
+  prng_t rng;
+  prng_seed(&rng, SEED);
+  double start = now();
+  char** strs = rand_strings(&rng, num, len);
+  double gen = now();
+  if (!strs) return EXIT_FAILURE;
+  char** dups = dup_strs(strs, num);
+  double dup = now();
+  if (!dups) {
+    destroy_strs(strs);
+    return EXIT_FAILURE;
+  }
+  destroy_strs(dups);
+  destroy_strs(strs);
+  double end = now();
+  report("per-string", gen - start, dup - gen, end - dup);
+
+  // One allocation per table.
+  strtab_t tab, tab_dups;
+  prng_seed(&rng, SEED);
+  start = now();
+  if (strtab_rand(&tab, num, len, &rng, NULL)) return EXIT_FAILURE;
+  gen = now();
+  if (strtab_dup(&tab_dups, &tab, NULL)) return EXIT_FAILURE;
+  dup = now();
+  strtab_destroy(&tab_dups);
+  strtab_destroy(&tab);
+  end = now();
+  report("strtab", gen - start, dup - gen, end - dup);
+
+  // Tables carved out of an arena.
+  arena_t arena;
+  if (arena_init(&arena, ARENA_MMAP, 0)) return EXIT_FAILURE;
+  prng_seed(&rng, SEED);
+  start = now();
+  if (strtab_rand(&tab, num, len, &rng, &arena)) return EXIT_FAILURE;
+  gen = now();
+  if (strtab_dup(&tab_dups, &tab, &arena)) return EXIT_FAILURE;
+  dup = now();
+  arena_destroy(&arena);
+  end = now();
+  report("strtab-arena", gen - start, dup - gen, end - dup);
+  return EXIT_SUCCESS;
+}
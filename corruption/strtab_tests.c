@@ -0,0 +1,77 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "strtab.h"
+
+/*----- Numerical Constants -----*/
+
+#define SEED              (42)
+#define NUM_STRINGS       (1000)
+#define STRING_LEN        (24)
+
+/*----- Function Implementations -----*/
+
+void check_equal(strtab_t const* left, strtab_t const* right) {
+  assert(strtab_count(left) == strtab_count(right));
+  for (size_t i = 0; i < strtab_count(left); ++i) {
+    assert(!strcmp(strtab_get(left, i), strtab_get(right, i)));
+  }
+}
+
+int main() {
+  // Random tables hold fixed length alphabetic strings.
+  prng_t rng;
+  prng_seed(&rng, SEED);
+  strtab_t strs, dups;
+  assert(!strtab_rand(&strs, NUM_STRINGS, STRING_LEN, &rng, NULL));
+  assert(strtab_count(&strs) == NUM_STRINGS);
+  for (size_t i = 0; i < NUM_STRINGS; ++i) {
+    char* str = strtab_get(&strs, i);
+    assert(strlen(str) == STRING_LEN);
+    for (size_t j = 0; j < STRING_LEN; ++j) assert(str[j] >= 'a' && str[j] <= 'z');
+  }
+  assert(!strtab_get(&strs, NUM_STRINGS) && errno == ERANGE);
+
+  // A duplicate is a separate copy with the same contents.
+  assert(!strtab_dup(&dups, &strs, NULL));
+  check_equal(&strs, &dups);
+  assert(strtab_get(&dups, 0) != strtab_get(&strs, 0));
+  strtab_get(&dups, 0)[0] = '!';
+  assert(strtab_get(&strs, 0)[0] != '!');
+  strtab_destroy(&dups);
+
+  // Tables can be built from a null terminated array of
+  // strings of any length, including empty ones.
+  char* words[] = {"", "a", "hello", "", "world!", NULL};
+  strtab_t packed;
+  assert(!strtab_from(&packed, words, NULL));
+  assert(strtab_count(&packed) == 5);
+  for (size_t i = 0; i < 5; ++i) assert(!strcmp(strtab_get(&packed, i), words[i]));
+
+  // Empty tables are fine too.
+  char* none[] = {NULL};
+  strtab_t empty;
+  assert(!strtab_from(&empty, none, NULL));
+  assert(strtab_count(&empty) == 0);
+  assert(!strtab_get(&empty, 0));
+  strtab_destroy(&empty);
+
+  // Arena backed tables are released with their arena.
+  arena_t arena;
+  assert(!arena_init(&arena, ARENA_MALLOC, 0));
+  assert(!strtab_dup(&dups, &strs, &arena));
+  check_equal(&strs, &dups);
+  assert(!strtab_dup(&empty, &packed, &arena));
+  check_equal(&packed, &empty);
+  strtab_destroy(&dups);
+  strtab_destroy(&empty);
+  arena_destroy(&arena);
+
+  strtab_destroy(&packed);
+  strtab_destroy(&strs);
+  return 0;
+}
@@ -0,0 +1,77 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "dstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_RECORDS       (10000000LL)
+#define MAX_RECORD            (64)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void run(size_t record_size, size_t align, int64_t records) {
+  dstack_config_t config = {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_CONTIGUOUS, 0, NULL, align};
+  dstack_t stk;
+  if (dstack_init_config(&stk, record_size, NULL, &config) || dstack_reserve(&stk, records)) {
+    perror("dstack_init_config");
+    exit(EXIT_FAILURE);
+  }
+
+  // Push every record, then peek at each one, reading the whole
+  // thing, and pop it. Reserving up front keeps growth out of it.
+  char record[MAX_RECORD] = {0};
+  double start = now();
+  for (int64_t i = 0; i < records; ++i) {
+    record[0] = (char) i;
+    dstack_push(&stk, record);
+  }
+  double push = (now() - start) * 1e9 / records;
+
+  uint64_t sum = 0;
+  start = now();
+  while (dstack_size(&stk)) {
+    uint64_t words[MAX_RECORD / sizeof(uint64_t)] = {0};
+    memcpy(words, dstack_peek(&stk), record_size);
+    for (size_t i = 0; i < record_size / sizeof(uint64_t); ++i) sum += words[i];
+    dstack_pop(&stk);
+  }
+  double peek = (now() - start) * 1e9 / records;
+
+  printf("%8zu %8zu %8zu %12.2f %12.2f %12" PRIu64 "\n",
+      record_size, align, dstack_stride(&stk), push, peek, sum);
+  dstack_destroy(&stk);
+}
+
+int main(int argc, char** argv) {
+  // Usage: align_bench [records]
+  int64_t records = DEFAULT_RECORDS;
+  if (argc >= 2) records = strtoll(argv[1], NULL, 10);
+
+  // Packed 24 and 40 byte records straddle cache lines, padded
+  // ones don't, at the cost of more memory.
+  size_t sizes[] = {24, 40};
+  size_t aligns[] = {0, 8, 32, 64};
+  printf("%8s %8s %8s %12s %12s %12s\n", "record", "align", "stride", "push ns", "peek+pop ns", "checksum");
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i) {
+    for (size_t j = 0; j < sizeof(aligns) / sizeof(*aligns); ++j) {
+      if (aligns[j] == 32 && sizes[i] > 32) continue;
+      run(sizes[i], aligns[j], records);
+    }
+  }
+  return 0;
+}
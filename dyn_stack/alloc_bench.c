@@ -0,0 +1,88 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+/*----- Project Includes -----*/
+
+#include "dstack.h"
+#include "dalloc.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_RECORDS       (100000000LL)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long peak_rss_kb(void) {
+  // On Linux ru_maxrss is reported in kilobytes.
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+int main(int argc, char** argv) {
+  // Usage: alloc_bench [records] [libc|arena|mmap|thp|hugetlb]
+  // Peak RSS is process-wide, so we measure a single allocator per run.
+  int64_t records = DEFAULT_RECORDS;
+  char const* name = argc >= 3 ? argv[2] : "libc";
+  if (argc >= 2) records = strtoll(argv[1], NULL, 10);
+
+  // The arena gets a single mmap'd block big enough for the whole
+  // run, so that every growth extends in place. Pages are only
+  // touched, and so only count towards RSS, as the stack grows.
+  arena_t arena;
+  dstack_allocator_t allocator = dstack_libc_allocator;
+  if (!strcmp(name, "arena")) {
+    if (arena_init(&arena, ARENA_MMAP, records * sizeof(int64_t) * 2)) {
+      perror("arena_init");
+      return 1;
+    }
+    allocator = dalloc_arena(&arena);
+  } else if (!strcmp(name, "mmap")) {
+    allocator = dalloc_mmap(DALLOC_HUGE_NONE);
+  } else if (!strcmp(name, "thp")) {
+    allocator = dalloc_mmap(DALLOC_HUGE_ADVISE);
+  } else if (!strcmp(name, "hugetlb")) {
+    allocator = dalloc_mmap(DALLOC_HUGE_TLB);
+  } else if (strcmp(name, "libc")) {
+    fprintf(stderr, "Unknown allocator \"%s\"\n", name);
+    return 1;
+  }
+
+  dstack_config_t config = {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_CONTIGUOUS, 0, &allocator};
+  dstack_t stk;
+  if (dstack_init_config(&stk, sizeof(int64_t), NULL, &config)) {
+    perror("dstack_init_config");
+    return 1;
+  }
+
+  // Push everything, timing the whole run.
+  double start = now();
+  for (int64_t val = 0; val < records; ++val) {
+    if (dstack_push(&stk, &val)) {
+      perror("dstack_push");
+      return 1;
+    }
+  }
+  double elapsed = now() - start;
+  if (*(int64_t*) dstack_peek(&stk) != records - 1) return 1;
+
+  printf("allocator=%s records=%" PRId64 " seconds=%.3f mpush_per_sec=%.1f peak_rss_mb=%.1f\n",
+      name, records, elapsed, records / elapsed / 1e6, peak_rss_kb() / 1024.0);
+
+  dstack_destroy(&stk);
+  if (!strcmp(name, "arena")) arena_destroy(&arena);
+  return 0;
+}
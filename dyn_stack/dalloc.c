@@ -0,0 +1,114 @@
+/*----- System Includes -----*/
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/*----- Project Includes -----*/
+
+#include "dalloc.h"
+
+/*----- Numerical Constants -----*/
+
+#define DALLOC_PAGE_SIZE            (4096)
+#define DALLOC_HUGE_PAGE_SIZE       (2 * 1024 * 1024)
+
+/*----- Function Implementations -----*/
+
+static void* arena_alloc_hook(void* ctx, size_t len, size_t align) {
+  if (align < ARENA_DEFAULT_ALIGN) align = ARENA_DEFAULT_ALIGN;
+  return arena_alloc_aligned((arena_t*) ctx, len, align);
+}
+
+static void* arena_realloc_hook(void* ctx, void* ptr, size_t old_len, size_t new_len, size_t align) {
+  if (align <= ARENA_DEFAULT_ALIGN) return arena_realloc((arena_t*) ctx, ptr, old_len, new_len);
+
+  // arena_realloc only keeps the default alignment when it has to
+  // move a block, so over-aligned blocks always move themselves.
+  void* tmp = arena_alloc_hook(ctx, new_len, align);
+  if (tmp && ptr) memcpy(tmp, ptr, old_len < new_len ? old_len : new_len);
+  return tmp;
+}
+
+static void arena_free_hook(void* ctx, void* ptr, size_t len) {
+  // Arenas release memory all at once.
+  (void) ctx;
+  (void) ptr;
+  (void) len;
+}
+
+dstack_allocator_t dalloc_arena(arena_t* arena) {
+  dstack_allocator_t allocator = {arena_alloc_hook, arena_realloc_hook, arena_free_hook, arena};
+  return allocator;
+}
+
+inline static int huge_mode(void* ctx) {
+  return (int) (intptr_t) ctx;
+}
+
+inline static size_t map_len(void* ctx, size_t len) {
+  // Round up to whole pages. Huge page mappings are always rounded
+  // to huge pages, even when we fell back to normal pages, so that
+  // we never need to remember which one we got.
+  size_t page = huge_mode(ctx) ? DALLOC_HUGE_PAGE_SIZE : DALLOC_PAGE_SIZE;
+  return (len + page - 1) & ~(page - 1);
+}
+
+inline static void advise(void* ctx, void* ptr, size_t len) {
+  // Failing to get huge pages isn't an error.
+  if (huge_mode(ctx)) madvise(ptr, len, MADV_HUGEPAGE);
+}
+
+static void* mmap_alloc_hook(void* ctx, size_t len, size_t align) {
+  // Mappings are page aligned, which covers any alignment
+  // a stack can ask for.
+  (void) align;
+  len = map_len(ctx, len);
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  void* ptr = MAP_FAILED;
+  if (huge_mode(ctx) == DALLOC_HUGE_TLB) {
+    ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+  }
+  if (ptr == MAP_FAILED) {
+    ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (ptr == MAP_FAILED) return NULL;
+    advise(ctx, ptr, len);
+  }
+  return ptr;
+}
+
+static void mmap_free_hook(void* ctx, void* ptr, size_t len) {
+  if (ptr) munmap(ptr, map_len(ctx, len));
+}
+
+static void* mmap_realloc_hook(void* ctx, void* ptr, size_t old_len, size_t new_len, size_t align) {
+  if (!ptr) return mmap_alloc_hook(ctx, new_len, align);
+
+  // Nothing to do if we're still on the same pages.
+  size_t old_map = map_len(ctx, old_len), new_map = map_len(ctx, new_len);
+  if (old_map == new_map) return ptr;
+
+  // Let the kernel move the pages if it has to.
+  void* tmp = mremap(ptr, old_map, new_map, MREMAP_MAYMOVE);
+  if (tmp != MAP_FAILED) {
+    advise(ctx, tmp, new_map);
+    return tmp;
+  }
+
+  // Some mappings, like hugetlbfs ones, can't always be remapped,
+  // so fall back to copying.
+  tmp = mmap_alloc_hook(ctx, new_len, align);
+  if (!tmp) return NULL;
+  memcpy(tmp, ptr, old_len < new_len ? old_len : new_len);
+  mmap_free_hook(ctx, ptr, old_len);
+  return tmp;
+}
+
+dstack_allocator_t dalloc_mmap(int huge) {
+  dstack_allocator_t allocator = {
+    mmap_alloc_hook, mmap_realloc_hook, mmap_free_hook, (void*) (intptr_t) huge
+  };
+  return allocator;
+}
@@ -0,0 +1,39 @@
+#ifndef DALLOC_H
+#define DALLOC_H
+
+/*----- System Includes -----*/
+
+#include <stddef.h>
+
+/*----- Project Includes -----*/
+
+#include "dstack.h"
+#include "../arena/arena.h"
+
+/*----- Numerical Constants -----*/
+
+// Huge page modes for dalloc_mmap.
+// DALLOC_HUGE_TLB maps from the reserved hugetlbfs pool, and falls
+// back to DALLOC_HUGE_ADVISE when the pool is empty or missing.
+// DALLOC_HUGE_ADVISE asks for transparent huge pages with madvise.
+#define DALLOC_HUGE_NONE            (0)
+#define DALLOC_HUGE_ADVISE          (1)
+#define DALLOC_HUGE_TLB             (2)
+
+/*----- Function Declarations -----*/
+
+// Ready-made allocators for dstack_config_t.
+// dstack_libc_allocator, in dstack.h, is the default.
+
+// Bump allocates out of an arena. Nothing is freed until the arena
+// is reset or destroyed, but growing the most recent allocation
+// happens in place, so a lone stack in a large arena never copies.
+dstack_allocator_t dalloc_arena(arena_t* arena);
+
+// Maps anonymous memory directly, growing with mremap so that
+// the kernel can move pages instead of copying them.
+// Huge page modes round every allocation up to 2 MiB, so they
+// suit contiguous stacks better than segmented ones.
+dstack_allocator_t dalloc_mmap(int huge);
+
+#endif
@@ -0,0 +1,154 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+/*----- Project Includes -----*/
+
+#include "dspill.h"
+
+/*----- Function Implementations -----*/
+
+inline static void sanity_check(dspill_t const* spill) {
+  // Records only live on disk when memory is holding more.
+  assert(spill && spill->spilled >= 0 && spill->budget >= 2 && spill->fd >= 0);
+  assert((int64_t) dstack_size(&spill->stk) <= spill->budget);
+}
+
+inline static off_t spill_offset(dspill_t const* spill, int64_t pos) {
+  return (off_t) pos * spill->stk.record_size;
+}
+
+static int write_at(int fd, void const* buf, size_t len, off_t offset) {
+  // pwrite can stop short, so keep going until it's all out.
+  char const* curr = (char const*) buf;
+  while (len) {
+    ssize_t written = pwrite(fd, curr, len, offset);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    curr += written;
+    offset += written;
+    len -= written;
+  }
+  return 0;
+}
+
+static int read_at(int fd, void* buf, size_t len, off_t offset) {
+  // Same as above, but the file can't end before we're done,
+  // since we wrote it.
+  char* curr = (char*) buf;
+  while (len) {
+    ssize_t got = pread(fd, curr, len, offset);
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    } else if (!got) {
+      errno = EIO;
+      return -1;
+    }
+    curr += got;
+    offset += got;
+    len -= got;
+  }
+  return 0;
+}
+
+static int spill_bottom(dspill_t* spill) {
+  // Write the bottom half of memory out after everything already
+  // spilled, then slide the top half down to take its place.
+  dstack_t* stk = &spill->stk;
+  int64_t half = spill->budget / 2;
+  size_t half_bytes = (size_t) half * stk->record_size;
+  size_t rest_bytes = (dstack_size(stk) - half) * stk->record_size;
+  if (write_at(spill->fd, stk->buffer, half_bytes, spill_offset(spill, spill->spilled))) return -1;
+  memmove(stk->buffer, (char*) stk->buffer + half_bytes, rest_bytes);
+
+  // Publish and return.
+  stk->pos -= half;
+  spill->spilled += half;
+  return 0;
+}
+
+static int page_in(dspill_t* spill) {
+  // Read the most recently spilled half budget back into
+  // the bottom of our, empty, in-memory stack.
+  dstack_t* stk = &spill->stk;
+  int64_t half = spill->budget / 2;
+  if (half > spill->spilled) half = spill->spilled;
+  off_t offset = spill_offset(spill, spill->spilled - half);
+  if (read_at(spill->fd, stk->buffer, (size_t) half * stk->record_size, offset)) return -1;
+
+  // Publish and return.
+  stk->pos = half - 1;
+  spill->spilled -= half;
+  return 0;
+}
+
+int dspill_init(dspill_t* spill, size_t record_size, size_t budget, int fd) {
+  // Check error conditions.
+  if (!spill || budget < 2 || budget > INT64_MAX || fd < 0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Reserve the whole budget up front. Our stack is contiguous,
+  // and never grows past it, so its buffer never moves.
+  if (dstack_init(&spill->stk, record_size, NULL)) return -1;
+  if (dstack_reserve(&spill->stk, budget)) {
+    dstack_destroy(&spill->stk);
+    errno = ENOMEM;
+    return -1;
+  }
+  spill->fd = fd;
+  spill->budget = budget;
+  spill->spilled = 0;
+  errno = 0;
+  return 0;
+}
+
+void dspill_destroy(dspill_t* spill) {
+  // The file belongs to our caller.
+  sanity_check(spill);
+  dstack_destroy(&spill->stk);
+}
+
+int dspill_push(dspill_t* spill, void const* val) {
+  // Check error conditions.
+  sanity_check(spill);
+  if (!val) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Make room in memory if we're at our budget.
+  if ((int64_t) dstack_size(&spill->stk) == spill->budget && spill_bottom(spill)) return -1;
+  return dstack_push(&spill->stk, val);
+}
+
+void* dspill_peek(dspill_t* spill) {
+  // If memory is empty, the top of the stack is on disk.
+  sanity_check(spill);
+  if (!dstack_size(&spill->stk) && spill->spilled && page_in(spill)) return NULL;
+  return dstack_peek(&spill->stk);
+}
+
+int dspill_pop(dspill_t* spill) {
+  sanity_check(spill);
+  if (!dstack_size(&spill->stk) && spill->spilled && page_in(spill)) return -1;
+  return dstack_pop(&spill->stk);
+}
+
+size_t dspill_size(dspill_t const* spill) {
+  sanity_check(spill);
+  return dstack_size(&spill->stk) + spill->spilled;
+}
+
+size_t dspill_spilled(dspill_t const* spill) {
+  sanity_check(spill);
+  return spill->spilled;
+}
@@ -0,0 +1,43 @@
+#ifndef DSPILL_H
+#define DSPILL_H
+
+/*----- System Includes -----*/
+
+#include <stddef.h>
+
+/*----- Project Includes -----*/
+
+#include "dstack.h"
+
+/*----- Type Declarations -----*/
+
+// A stack that holds at most budget records in memory.
+// Once the in-memory stack fills up, its bottom half is written
+// out to the end of fd, and once pops empty it, the most recently
+// spilled records are read back in, so every record is written
+// and read at most once per trip across the budget.
+// Records are copied byte for byte, and there's no destructor, since
+// spilled records can't be destroyed without reading them back.
+typedef struct dspill {
+  dstack_t stk;
+  int fd;
+  int64_t budget, spilled;
+} dspill_t;
+
+/*----- Function Declarations -----*/
+
+// Lifecycle functions
+// budget must be at least two records. fd must be open for reading
+// and writing, and belongs to the caller. Anything already in the
+// file is overwritten.
+int dspill_init(dspill_t* spill, size_t record_size, size_t budget, int fd);
+void dspill_destroy(dspill_t* spill);
+
+// Stack operations
+int dspill_push(dspill_t* spill, void const* val);
+void* dspill_peek(dspill_t* spill);
+int dspill_pop(dspill_t* spill);
+size_t dspill_size(dspill_t const* spill);
+size_t dspill_spilled(dspill_t const* spill);
+
+#endif
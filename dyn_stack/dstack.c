@@ -1,8 +1,17 @@
 /*----- System Includes -----*/
 
+#define _GNU_SOURCE
+
 #include <assert.h>
+#include <fcntl.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 /*----- Project Includes -----*/
 
@@ -11,83 +20,640 @@
 /*----- Numerical Constants -----*/
 
 #define DSTACK_INIT_CAPACITY              (8)
+#define DSTACK_INIT_DIRECTORY             (8)
+#define DSTACK_SEGMENT_BYTES              (64 * 1024)
+#define DSTACK_FILE_MAGIC                 (0x4b4341545344ULL)     // "DSTACK"
+#define DSTACK_FILE_VERSION               (2)
+
+// glibc's malloc aligns to two words, anything past that
+// needs posix_memalign.
+#define DSTACK_MALLOC_ALIGN               (2 * sizeof(void*))
+#define DSTACK_SNAP_MAGIC                 (0x50414e534b545344ULL) // "DSTKSNAP"
+#define DSTACK_SNAP_VERSION               (1)
+#define DSTACK_SNAP_IOVECS                (64)
+
+/*----- Type Declarations -----*/
+
+// The header at the start of a mapped stack's file.
+// It's padded out so that the records after it stay aligned.
+typedef union dstack_file_header {
+  struct {
+    uint64_t magic;
+    uint32_t version;
+    int64_t pos, capacity;
+    uint64_t record_size, stride;
+  } fields;
+  char pad[DSTACK_FILE_HEADER];
+} dstack_file_header_t;
+
+// The header at the start of a snapshot, followed by count records
+// ordered bottom to top.
+typedef struct dstack_snap_header {
+  uint64_t magic;
+  uint32_t version, reserved;
+  uint64_t record_size, count;
+} dstack_snap_header_t;
 
 /*----- Function Implementations -----*/
 
+static void* libc_alloc(void* ctx, size_t len, size_t align) {
+  (void) ctx;
+  if (align <= DSTACK_MALLOC_ALIGN) return malloc(len);
+
+  void* ptr;
+  return posix_memalign(&ptr, align, len) ? NULL : ptr;
+}
+
+static void* libc_realloc(void* ctx, void* ptr, size_t old_len, size_t new_len, size_t align) {
+  if (align <= DSTACK_MALLOC_ALIGN) return realloc(ptr, new_len);
+
+  // realloc doesn't know about alignment, so we have to
+  // move the block ourselves.
+  void* tmp = libc_alloc(ctx, new_len, align);
+  if (!tmp) return NULL;
+  if (ptr) memcpy(tmp, ptr, old_len < new_len ? old_len : new_len);
+  free(ptr);
+  return tmp;
+}
+
+static void libc_free(void* ctx, void* ptr, size_t len) {
+  (void) ctx;
+  (void) len;
+  free(ptr);
+}
+
+// The default allocator, declared in dstack.h.
+dstack_allocator_t const dstack_libc_allocator = {libc_alloc, libc_realloc, libc_free, NULL};
+
 inline static void sanity_check(dstack_t const* stk) {
   // Make sure our basic invariants hold.
-  assert(stk && stk->pos < DSTACK_SIZE && stk->pos >= DSTACK_BASE && stk->capacity);
+  assert(stk && stk->pos < stk->capacity && stk->pos >= DSTACK_BASE && stk->capacity);
+}
+
+inline static int is_segmented(dstack_t const* stk) {
+  return stk->storage == DSTACK_STORAGE_SEGMENTED;
+}
+
+inline static int is_mapped(dstack_t const* stk) {
+  return stk->storage == DSTACK_STORAGE_MAPPED;
+}
+
+inline static dstack_file_header_t* file_header(dstack_t const* stk) {
+  return (dstack_file_header_t*) stk->map;
+}
+
+inline static size_t mapping_bytes(int64_t capacity, size_t stride) {
+  return sizeof(dstack_file_header_t) + (size_t) capacity * stride;
+}
+
+inline static int64_t segment_mask(dstack_t const* stk) {
+  return ((int64_t) 1 << stk->seg_shift) - 1;
+}
+
+inline static size_t buffer_bytes(dstack_t const* stk) {
+  return (size_t) stk->capacity * stk->stride;
+}
+
+inline static size_t segment_bytes(dstack_t const* stk) {
+  return stk->stride << stk->seg_shift;
+}
+
+inline static size_t record_offset(dstack_t const* stk, int64_t pos) {
+  // Power of two strides, which is every stride once records are
+  // padded out to a cache line, are a shift rather than a multiply.
+  if (stk->stride_shift >= 0) return (size_t) pos << stk->stride_shift;
+  return (size_t) pos * stk->stride;
+}
+
+inline static size_t directory_bytes(dstack_t const* stk) {
+  return sizeof(void*) * stk->directory;
 }
 
 inline static void* calc_ptr(dstack_t* stk, int64_t pos) {
+  // A segmented stack first finds the segment holding the record,
+  // and then the record's offset inside of it.
+  // Segments hold a power of two records, so both of those
+  // are a shift and a mask rather than a divide.
+  if (is_segmented(stk)) {
+    char* segment = (char*) stk->segments[pos >> stk->seg_shift];
+    return segment + record_offset(stk, pos & segment_mask(stk));
+  }
+
   // Calculate the base address of the requested record.
   // We cast the buffer to a character pointer so that
   // our pointer arithmetic will work in terms of bytes
   // Then we take the requested array position, multiplied
-  // by the size of each record to compute the address
-  return ((char*) stk->buffer) + (pos * stk->record_size);
+  // by the stride between records to compute the address
+  // The multiply is done in size_t, which can't overflow
+  // because extend_stack never lets capacity * stride
+  // exceed SIZE_MAX.
+  return ((char*) stk->buffer) + record_offset(stk, pos);
 }
 
-inline static int extend_stack(dstack_t* stk) {
-  // Calculate our new intended capacity.
-  int64_t target = stk->capacity * 2;
+inline static int is_packed(dstack_t const* stk) {
+  return stk->stride == stk->record_size;
+}
+
+inline static int64_t run_length(dstack_t const* stk, int64_t pos, int64_t end) {
+  // Count the records from pos up to end that sit back to back
+  // in memory, which for a segmented stack stops at the end of
+  // pos's segment.
+  int64_t num = end - pos;
+  if (is_segmented(stk)) {
+    int64_t room = segment_mask(stk) + 1 - (pos & segment_mask(stk));
+    if (room < num) num = room;
+  }
+  return num;
+}
 
-  // Realloc can be used to extend a previous allocation.
-  // If the extension fails, the original buffer will be untouched.
-  void* tmp = realloc(stk->buffer, target * stk->record_size);
+static void copy_in(dstack_t* stk, int64_t pos, char const* src, int64_t num) {
+  // Copy a run of packed records into the stack.
+  // Padded records need a copy each to step over the padding.
+  char* dst = (char*) calc_ptr(stk, pos);
+  if (is_packed(stk)) {
+    memcpy(dst, src, (size_t) num * stk->record_size);
+    return;
+  }
+  for (int64_t i = 0; i < num; ++i, dst += stk->stride, src += stk->record_size) {
+    memcpy(dst, src, stk->record_size);
+  }
+}
+
+inline static int publish_status(dstack_status_t status) {
+  // Translate a status into the errno convention
+  // used by the rest of the API.
+  switch (status) {
+    case DSTACK_OK:
+      errno = 0;
+      return 0;
+    case DSTACK_EMPTY:
+      errno = ENOENT;
+      break;
+    case DSTACK_NOMEM:
+      errno = ENOMEM;
+      break;
+    default:
+      errno = EINVAL;
+      break;
+  }
+  return -1;
+}
+
+inline static int64_t max_capacity(dstack_t const* stk) {
+  // The largest number of records we can ever hold is bounded
+  // both by our signed position type, and by the largest
+  // buffer size we can ask the allocator for.
+  // A mapped stack also has to fit its header.
+  size_t max = (SIZE_MAX - sizeof(dstack_file_header_t)) / stk->stride;
+  return max > INT64_MAX ? INT64_MAX : (int64_t) max;
+}
+
+inline static int64_t grow_capacity(dstack_t const* stk, int64_t capacity, int64_t max) {
+  // Calculate the next capacity according to our growth policy,
+  // clamping to max rather than overflowing.
+  int64_t step;
+  switch (stk->growth) {
+    case DSTACK_GROW_HALF:
+      step = capacity / 2 ? capacity / 2 : 1;
+      break;
+    case DSTACK_GROW_CHUNK:
+      step = stk->chunk;
+      break;
+    default:
+      step = capacity;
+      break;
+  }
+  return step > max - capacity ? max : capacity + step;
+}
+
+static unsigned segment_shift(size_t stride) {
+  // Fit as many records into a segment as we can, rounded
+  // down to a power of two, but always at least one.
+  unsigned shift = 0;
+  while (((size_t) 2 << shift) * stride <= DSTACK_SEGMENT_BYTES) ++shift;
+  return shift;
+}
+
+static int extend_segments(dstack_t* stk, int64_t needed) {
+  // Allocate new segments until we can hold the requested records.
+  // Existing segments are never touched, so no record ever moves.
+  while (stk->capacity < needed) {
+    int64_t idx = stk->capacity >> stk->seg_shift;
+    if (idx == stk->directory) {
+      // The directory itself is full.
+      // Growing it only moves segment pointers, which are a tiny
+      // fraction of the data, so this stays cheap at any size.
+      size_t len = sizeof(void*) * stk->directory;
+      void** tmp = stk->allocator.realloc(stk->allocator.ctx, stk->segments, len, len * 2, 0);
+      if (!tmp) return -1;
+      stk->segments = tmp;
+      stk->directory *= 2;
+    }
+
+    void* segment = stk->allocator.alloc(stk->allocator.ctx, segment_bytes(stk), stk->align);
+    if (!segment) return -1;
+    stk->segments[idx] = segment;
+    stk->capacity += segment_mask(stk) + 1;
+  }
+  return 0;
+}
+
+static int resize_mapping(dstack_t* stk, int64_t target) {
+  // The file has to be at least as large as the mapping before
+  // we touch the new pages, and we can't truncate it until they're
+  // unmapped, so the order depends on which way we're going.
+  size_t old_len = mapping_bytes(stk->capacity, stk->stride);
+  size_t new_len = mapping_bytes(target, stk->stride);
+  if (new_len > old_len && ftruncate(stk->fd, new_len)) return -1;
+
+  // mremap can extend the mapping in place, or move it if it has to,
+  // without copying anything either way.
+  void* tmp = mremap(stk->map, old_len, new_len, MREMAP_MAYMOVE);
+  if (tmp == MAP_FAILED) {
+    if (new_len > old_len) ftruncate(stk->fd, old_len);
+    return -1;
+  }
+  if (new_len < old_len) ftruncate(stk->fd, new_len);
+
+  // Stuff worked, update and return.
+  stk->map = tmp;
+  stk->buffer = (char*) tmp + sizeof(dstack_file_header_t);
+  stk->capacity = target;
+  file_header(stk)->fields.capacity = target;
+  return 0;
+}
+
+inline static int resize_buffer(dstack_t* stk, int64_t target) {
+  // Mapped stacks grow their file instead.
+  if (is_mapped(stk)) return resize_mapping(stk, target);
+
+  // Realloc can be used to extend or shrink a previous allocation.
+  // If the resize fails, the original buffer will be untouched.
+  void* tmp = stk->allocator.realloc(stk->allocator.ctx, stk->buffer,
+      buffer_bytes(stk), (size_t) target * stk->stride, stk->align);
   if (!tmp) return -1;
 
   // Stuff worked, the old buffer is now dangling, update and return.
   stk->buffer = tmp;
-  stk->capacity *= 2;
+  stk->capacity = target;
   return 0;
 }
 
+inline static int64_t segments_used(dstack_t const* stk) {
+  // Count the segments holding at least one record.
+  // We always keep the first segment, even when empty.
+  return stk->pos < 0 ? 1 : (stk->pos >> stk->seg_shift) + 1;
+}
+
+static void release_segments(dstack_t* stk, int64_t keep) {
+  // Free every segment past the first keep segments.
+  int64_t count = stk->capacity >> stk->seg_shift;
+  while (count > keep) {
+    stk->allocator.free(stk->allocator.ctx, stk->segments[--count], segment_bytes(stk));
+  }
+  stk->capacity = count << stk->seg_shift;
+}
+
+static void shrink_stack(dstack_t* stk) {
+  if (is_segmented(stk)) {
+    // Hang on to one spare segment past the ones in use, so that
+    // pushing and popping across a segment boundary doesn't
+    // allocate and free a segment every time, and to every
+    // segment a reservation asked for.
+    int64_t keep = segments_used(stk) + 1;
+    int64_t reserved = (stk->reserved + segment_mask(stk)) >> stk->seg_shift;
+    if (keep < reserved) keep = reserved;
+    if ((stk->capacity >> stk->seg_shift) > keep) release_segments(stk, keep);
+    return;
+  }
+
+  // Halve the buffer while it's less than a quarter full.
+  // Halving leaves the stack at most half full, so occupancy has
+  // to double again before we grow, which keeps us from thrashing
+  // when the size hovers around a boundary.
+  // We never shrink below what was reserved.
+  int64_t size = stk->pos + 1;
+  int64_t target = stk->capacity;
+  int64_t floor = stk->reserved > DSTACK_INIT_CAPACITY ? stk->reserved : DSTACK_INIT_CAPACITY;
+  while (target / 2 >= floor && size < target / 4) target /= 2;
+
+  // Failing to shrink isn't an error, we just keep the larger buffer.
+  if (target != stk->capacity) resize_buffer(stk, target);
+}
+
+inline static int resize_storage(dstack_t* stk, int64_t target) {
+  // Segmented stacks grow one segment at a time, everything
+  // else resizes its buffer or mapping in one go.
+  if (is_segmented(stk)) return extend_segments(stk, target);
+  return resize_buffer(stk, target);
+}
+
+inline static int grow_to(dstack_t* stk, int64_t target) {
+  // Every growth goes through here, whether it came from a push
+  // or a reservation, so the stats see all of it.
+#ifdef STACK_STATS
+  // Time the growth, and count the bytes the allocator had to
+  // carry over, which realloc may have managed in place.
+  // Segments never move, and mremap doesn't copy.
+  uint64_t start = stkstats_ticks();
+  size_t moved = is_segmented(stk) || is_mapped(stk) ? 0 : buffer_bytes(stk);
+  int err = resize_storage(stk, target);
+  if (!err) stkstats_grow(stk->stats, moved, stkstats_ticks() - start);
+  return err;
+#else
+  return resize_storage(stk, target);
+#endif
+}
+
+inline static int extend_stack(dstack_t* stk, int64_t needed) {
+  // Make sure the request is satisfiable at all.
+  // We leave errno to our callers, so that the errno-free
+  // operations can use this too.
+  int64_t max = max_capacity(stk);
+  if (needed > max) return -1;
+
+  // Segmented stacks grow one segment at a time, regardless
+  // of the growth policy.
+  if (is_segmented(stk)) return grow_to(stk, needed);
+
+  // Calculate our new intended capacity.
+  // Keep growing until we can hold at least the requested
+  // number of records, so that a batch push only needs to
+  // reallocate once.
+  int64_t target = stk->capacity;
+  while (target < needed) target = grow_capacity(stk, target, max);
+  return grow_to(stk, target);
+}
+
 int dstack_init(dstack_t* stk, size_t record_size, void (*destroy) (void*)) {
-  // If we were given something, initialize it.
-  if (stk) {
-    stk->pos = DSTACK_BASE;
+  return dstack_init_config(stk, record_size, destroy, NULL);
+}
+
+static int init_segments(dstack_t* stk) {
+  // Start with an empty directory, and then allocate
+  // our first segment.
+  stk->capacity = 0;
+  stk->seg_shift = segment_shift(stk->stride);
+  stk->directory = DSTACK_INIT_DIRECTORY;
+  stk->segments = stk->allocator.alloc(stk->allocator.ctx, directory_bytes(stk), 0);
+  if (!stk->segments) return -1;
+
+  if (extend_segments(stk, 1)) {
+    stk->allocator.free(stk->allocator.ctx, stk->segments, directory_bytes(stk));
+    return -1;
+  }
+  return 0;
+}
+
+static int init_fields(dstack_t* stk, size_t record_size,
+    void (*destroy) (void*), dstack_config_t const* config) {
+  // Validate the configuration, if we were given one, and set up
+  // everything but the storage itself.
+  // A chunked growth policy needs to know how big a chunk is.
+  if (config && config->growth == DSTACK_GROW_CHUNK && config->chunk <= 0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Alignments have to be powers of two, and no more than a page.
+  size_t align = config ? config->align : 0;
+  if (align & (align - 1) || align > DSTACK_MAX_ALIGN || !stk || !record_size) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  stk->pos = DSTACK_BASE;
+  stk->reserved = 0;
+  stk->record_size = record_size;
+  stk->align = align;
+  stk->stride = align ? (record_size + align - 1) & ~(align - 1) : record_size;
+  stk->stride_shift = -1;
+  if (!(stk->stride & (stk->stride - 1))) {
+    stk->stride_shift = 0;
+    while (((size_t) 1 << stk->stride_shift) < stk->stride) ++stk->stride_shift;
+  }
+  stk->growth = config ? config->growth : DSTACK_GROW_DOUBLE;
+  stk->chunk = config ? config->chunk : 0;
+  stk->storage = config ? config->storage : DSTACK_STORAGE_CONTIGUOUS;
+  stk->shrink = config ? config->shrink : 0;
+  stk->allocator = config && config->allocator ? *config->allocator : dstack_libc_allocator;
+  stk->destroy = destroy;
+  stk->buffer = NULL;
+  stk->segments = NULL;
+  stk->map = NULL;
+  stk->fd = -1;
+  return 0;
+}
+
+int dstack_init_config(dstack_t* stk, size_t record_size,
+    void (*destroy) (void*), dstack_config_t const* config) {
+  // Mapped stacks need a file, which only dstack_open can give them.
+  if (config && config->storage == DSTACK_STORAGE_MAPPED) {
+    errno = EINVAL;
+    return -1;
+  }
+  if (init_fields(stk, record_size, destroy, config)) return -1;
+
+  // We need to check if allocation failed, as we could otherwise
+  // leak a partially initialized stack.
+  int err;
+  if (is_segmented(stk)) {
+    err = init_segments(stk);
+  } else {
     stk->capacity = DSTACK_INIT_CAPACITY;
-    stk->record_size = record_size;
-    stk->buffer = malloc(record_size * DSTACK_INIT_CAPACITY);
-    stk->destroy = destroy;
+    stk->buffer = stk->allocator.alloc(stk->allocator.ctx, buffer_bytes(stk), stk->align);
+    err = !stk->buffer;
+  }
+  if (err) return -1;
+#ifdef STACK_STATS
+  stk->stats = stkstats_register("dstack", record_size);
+#endif
+  errno = 0;
+  return 0;
+}
 
-    // We need to check if malloc failed, as we could otherwise
-    // leak a partially initialized stack.
-    if (stk->buffer) {
-      errno = 0;
-      return 0;
-    } else {
+static void discard_file(dstack_t* stk, char const* path, int created) {
+  // Put a brand new file back the way we found it, so that a failed
+  // open doesn't leave behind a file with no header, which every
+  // later open would reject.
+  int err = errno;
+  if (created) {
+    unlink(path);
+  } else {
+    ftruncate(stk->fd, 0);
+  }
+  errno = err;
+}
+
+static int open_file(dstack_t* stk, char const* path) {
+  // Open the file, creating it if we have to, and remember
+  // whether we did.
+  int created = 1;
+  stk->fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (stk->fd < 0 && errno == EEXIST) {
+    created = 0;
+    stk->fd = open(path, O_RDWR);
+  }
+  if (stk->fd < 0) return -1;
+
+  struct stat st;
+  if (fstat(stk->fd, &st)) {
+    if (created) discard_file(stk, path, created);
+    return -1;
+  }
+  int fresh = !st.st_size;
+  if (fresh) {
+    // A brand new file, size it for our initial capacity.
+    // The header only gets written once it's mapped, so until then
+    // any failure has to put the file back.
+    stk->capacity = DSTACK_INIT_CAPACITY;
+    if (stk->capacity > max_capacity(stk)) {
+      errno = EINVAL;
+      discard_file(stk, path, created);
+      return -1;
+    } else if (ftruncate(stk->fd, mapping_bytes(stk->capacity, stk->stride))) {
+      discard_file(stk, path, created);
       return -1;
     }
   } else {
+    // An existing stack, read the header and make sure it's
+    // a stack we can use.
+    dstack_file_header_t header;
+    if ((size_t) st.st_size < sizeof(header)) {
+      errno = EINVAL;
+      return -1;
+    } else if (pread(stk->fd, &header, sizeof(header), 0) != sizeof(header)) {
+      return -1;
+    }
+
+    int64_t capacity = header.fields.capacity, pos = header.fields.pos;
+    if (header.fields.magic != DSTACK_FILE_MAGIC
+        || header.fields.version != DSTACK_FILE_VERSION
+        || header.fields.record_size != stk->record_size
+        || header.fields.stride != stk->stride
+        || capacity <= 0 || capacity > max_capacity(stk)
+        || pos < DSTACK_BASE || pos >= capacity
+        || (uint64_t) st.st_size < mapping_bytes(capacity, stk->stride)) {
+      errno = EINVAL;
+      return -1;
+    }
+    stk->capacity = capacity;
+    stk->pos = pos;
+  }
+
+  // Map the whole thing. Nothing is read until it's touched, which
+  // is what makes reopening a large stack cheap.
+  size_t len = mapping_bytes(stk->capacity, stk->stride);
+  void* map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, stk->fd, 0);
+  if (map == MAP_FAILED) {
+    if (fresh) discard_file(stk, path, created);
+    return -1;
+  }
+  stk->map = map;
+  stk->buffer = (char*) map + sizeof(dstack_file_header_t);
+
+  // Stamp the header, which is a no-op for an existing stack.
+  dstack_file_header_t* header = file_header(stk);
+  header->fields.magic = DSTACK_FILE_MAGIC;
+  header->fields.version = DSTACK_FILE_VERSION;
+  header->fields.record_size = stk->record_size;
+  header->fields.stride = stk->stride;
+  header->fields.capacity = stk->capacity;
+  header->fields.pos = stk->pos;
+  return 0;
+}
+
+int dstack_open(dstack_t* stk, char const* path, size_t record_size,
+    void (*destroy) (void*), dstack_config_t const* config) {
+  // Check error conditions.
+  // Records start right after the header, which only lines
+  // them up to the header's size.
+  if (!path || (config && config->align > DSTACK_FILE_HEADER)) {
     errno = EINVAL;
     return -1;
   }
+
+  // Set up the stack's fields, and then map the file in
+  // as its storage, without ever allocating a buffer.
+  if (init_fields(stk, record_size, destroy, config)) return -1;
+  stk->storage = DSTACK_STORAGE_MAPPED;
+  stk->allocator = dstack_libc_allocator;
+
+  // Close the file again if we couldn't use it, without
+  // losing the errno that told us why.
+  if (open_file(stk, path)) {
+    int err = errno;
+    if (stk->fd >= 0) close(stk->fd);
+    errno = err;
+    return -1;
+  }
+
+  // A reopened stack starts out as deep as it was left.
+#ifdef STACK_STATS
+  stk->stats = stkstats_register("dstack", record_size);
+#endif
+  STKSTATS_PUSH(stk->stats, 0, stk->pos + 1);
+  errno = 0;
+  return 0;
+}
+
+int dstack_sync(dstack_t* stk) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (!is_mapped(stk)) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // The header only learns our size at checkpoints, so that
+  // pushes and pops don't have to write it every time.
+  file_header(stk)->fields.pos = stk->pos;
+  if (msync(stk->map, mapping_bytes(stk->capacity, stk->stride), MS_SYNC)) return -1;
+  errno = 0;
+  return 0;
 }
 
 void dstack_destroy(dstack_t* stk) {
+  // A mapped stack leaves its records in the file, and just
+  // records how many there are before letting go of the mapping.
+  if (is_mapped(stk)) {
+    file_header(stk)->fields.pos = stk->pos;
+    munmap(stk->map, mapping_bytes(stk->capacity, stk->stride));
+    close(stk->fd);
+#ifdef STACK_STATS
+    stkstats_unregister(stk->stats);
+#endif
+    return;
+  }
+
   // Spin and destroy any remaining
   // values on the stack.
   while (dstack_size(stk)) dstack_pop(stk);
 
   // Destroy the buffer.
-  free(stk->buffer);
+  if (is_segmented(stk)) {
+    release_segments(stk, 0);
+    stk->allocator.free(stk->allocator.ctx, stk->segments, directory_bytes(stk));
+  } else {
+    stk->allocator.free(stk->allocator.ctx, stk->buffer, buffer_bytes(stk));
+  }
+#ifdef STACK_STATS
+  stkstats_unregister(stk->stats);
+#endif
 }
 
-int dstack_push(dstack_t* stk, void const* val) {
+dstack_status_t dstack_try_push(dstack_t* stk, void const* val) {
   // Check error conditions.
   sanity_check(stk);
   int64_t target = stk->pos + 1;
-  if (target == stk->capacity) {
-    // We've hit our current capacity
-    // Double the storage if we can, or return error
-    int err = extend_stack(stk);
-    if (err) return -1;
-  } else if (!val) {
+  if (!val) {
     // User didn't give us a value to push.
-    errno = EINVAL;
-    return -1;
+    return DSTACK_INVALID;
+  } else if (target == stk->capacity) {
+    // We've hit our current capacity
+    // Grow the storage if we can, or return error
+    int err = extend_stack(stk, target + 1);
+    if (err) return DSTACK_NOMEM;
   }
 
   // Write the value into the stack.
@@ -105,37 +671,189 @@ int dstack_push(dstack_t* stk, void const* val) {
 
   // Publish and return.
   ++stk->pos;
+  STKSTATS_PUSH(stk->stats, 1, target + 1);
+  return DSTACK_OK;
+}
+
+dstack_status_t dstack_try_peek(dstack_t* stk, void** out) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (!out) {
+    return DSTACK_INVALID;
+  } else if (stk->pos < 0) {
+    return DSTACK_EMPTY;
+  }
+
+  // Hand back the current value.
+  *out = calc_ptr(stk, stk->pos);
+  return DSTACK_OK;
+}
+
+dstack_status_t dstack_try_pop(dstack_t* stk) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (stk->pos == DSTACK_BASE) {
+    return DSTACK_EMPTY;
+  }
+
+  // If we were given a destructor
+  // Destroy the current value on the stack
+  if (stk->destroy) stk->destroy(calc_ptr(stk, stk->pos));
+
+  // Publish, release memory if we're configured to, and return.
+  --stk->pos;
+  STKSTATS_POP(stk->stats, 1, stk->pos + 1);
+  if (stk->shrink) shrink_stack(stk);
+  return DSTACK_OK;
+}
+
+int dstack_push(dstack_t* stk, void const* val) {
+  return publish_status(dstack_try_push(stk, val));
+}
+
+void* dstack_peek(dstack_t* stk) {
+  void* val;
+  if (publish_status(dstack_try_peek(stk, &val))) return NULL;
+  return val;
+}
+
+int dstack_pop(dstack_t* stk) {
+  return publish_status(dstack_try_pop(stk));
+}
+
+int dstack_push_n(dstack_t* stk, void const* vals, size_t count) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (!vals) {
+    // User didn't give us any values to push.
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Make sure the whole batch fits with a single capacity check.
+  // The records will occupy positions [pos + 1, pos + count].
+  // Compare before adding so that a huge count can't overflow.
+  int64_t target = stk->pos + 1;
+  if (count > (uint64_t) (INT64_MAX - target)) {
+    errno = ENOMEM;
+    return -1;
+  }
+  int64_t needed = target + (int64_t) count;
+  if (needed > stk->capacity) {
+    int err = extend_stack(stk, needed);
+    if (err) {
+      errno = ENOMEM;
+      return -1;
+    }
+  }
+
+  // The records are contiguous both in the caller's array
+  // and in our buffer, so the whole batch is one copy.
+  // A segmented stack needs one copy per segment the batch touches.
+  char const* src = (char const*) vals;
+  for (int64_t pos = target; pos < needed;) {
+    int64_t num = run_length(stk, pos, needed);
+    copy_in(stk, pos, src, num);
+    src += (size_t) num * stk->record_size;
+    pos += num;
+  }
+
+  // Publish and return.
+  stk->pos += count;
+  STKSTATS_PUSH(stk->stats, count, stk->pos + 1);
   errno = 0;
   return 0;
 }
 
-void* dstack_peek(dstack_t* stk) {
+void* dstack_peek_n(dstack_t* stk, size_t count) {
   // Check error conditions.
   sanity_check(stk);
-  if (stk->pos < 0) {
+  if (!count) {
+    errno = EINVAL;
+    return NULL;
+  } else if (count > dstack_size(stk)) {
     errno = ENOENT;
     return NULL;
   }
 
-  // Return the current value.
+  // A segmented stack can only hand out a contiguous view
+  // when the records all live in the same segment.
+  int64_t first = stk->pos - count + 1;
+  if (is_segmented(stk) && (first >> stk->seg_shift) != (stk->pos >> stk->seg_shift)) {
+    errno = ERANGE;
+    return NULL;
+  }
+
+  // Return a view of the top count records.
+  // The view is ordered bottom to top, so the last
+  // record in it is the one dstack_peek would return.
   errno = 0;
-  return calc_ptr(stk, stk->pos);
+  return calc_ptr(stk, first);
 }
 
-int dstack_pop(dstack_t* stk) {
+int dstack_pop_n(dstack_t* stk, size_t count) {
   // Check error conditions.
   sanity_check(stk);
-  if (stk->pos == DSTACK_BASE) {
+  if (count > dstack_size(stk)) {
     errno = ENOENT;
     return -1;
   }
 
-  // If we were given a destructor
-  // Destroy the current value on the stack
-  if (stk->destroy) stk->destroy(calc_ptr(stk, stk->pos));
+  // If we were given a destructor, run it over the
+  // whole range, top down, same as repeated pops would.
+  int64_t target = stk->pos - count;
+  if (stk->destroy) {
+    for (int64_t i = stk->pos; i > target; --i) stk->destroy(calc_ptr(stk, i));
+  }
 
-  // Publish and return.
-  --stk->pos;
+  // Publish, release memory if we're configured to, and return.
+  stk->pos = target;
+  STKSTATS_POP(stk->stats, count, stk->pos + 1);
+  if (stk->shrink) shrink_stack(stk);
+  errno = 0;
+  return 0;
+}
+
+int dstack_reserve(dstack_t* stk, size_t count) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (count > (uint64_t) max_capacity(stk)) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // Grow straight to the requested capacity, bypassing the
+  // growth policy, since the caller knows what they need.
+  if ((int64_t) count > stk->capacity) {
+    if (grow_to(stk, count)) {
+      errno = ENOMEM;
+      return -1;
+    }
+  }
+
+  // Remember the reservation, so auto-shrinking doesn't undo it.
+  if ((int64_t) count > stk->reserved) stk->reserved = count;
+  errno = 0;
+  return 0;
+}
+
+int dstack_shrink_to_fit(dstack_t* stk) {
+  // Check error conditions.
+  sanity_check(stk);
+
+  // Release everything we aren't using right now, including
+  // any reservation.
+  // We always keep room for at least one record.
+  if (is_segmented(stk)) {
+    release_segments(stk, segments_used(stk));
+  } else {
+    int64_t target = stk->pos + 1 ? stk->pos + 1 : 1;
+    if (target != stk->capacity && resize_buffer(stk, target)) {
+      errno = ENOMEM;
+      return -1;
+    }
+  }
+  stk->reserved = 0;
   errno = 0;
   return 0;
 }
@@ -151,3 +869,144 @@ size_t dstack_size(dstack_t const* stk) {
 size_t dstack_capacity(dstack_t const* stk) {
   return stk->capacity;
 }
+
+size_t dstack_stride(dstack_t const* stk) {
+  return stk->stride;
+}
+
+int dstack_stats(dstack_t const* stk, stkstats_t* out) {
+  // Check error conditions.
+  if (!stk || !out) {
+    errno = EINVAL;
+    return -1;
+  }
+#ifdef STACK_STATS
+  if (stk->stats) {
+    *out = *stk->stats;
+    out->prev = out->next = NULL;
+    errno = 0;
+    return 0;
+  }
+#endif
+  errno = ENOTSUP;
+  return -1;
+}
+
+static int write_all(int fd, struct iovec* iov, int count) {
+  // writev can stop short, and can only take so many buffers at once,
+  // so keep going until every buffer is written out.
+  while (count) {
+    ssize_t written = writev(fd, iov, count < IOV_MAX ? count : IOV_MAX);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+
+    // Skip past whatever made it out.
+    while (count && (size_t) written >= iov->iov_len) {
+      written -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count) {
+      iov->iov_base = (char*) iov->iov_base + written;
+      iov->iov_len -= written;
+    }
+  }
+  return 0;
+}
+
+static int read_all(int fd, void* buf, size_t len) {
+  // Same as above, but hitting the end of the file early means
+  // the snapshot was cut short.
+  char* curr = (char*) buf;
+  while (len) {
+    ssize_t got = read(fd, curr, len);
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    } else if (!got) {
+      errno = EINVAL;
+      return -1;
+    }
+    curr += got;
+    len -= got;
+  }
+  return 0;
+}
+
+int dstack_save(dstack_t* stk, int fd) {
+  // Check error conditions.
+  sanity_check(stk);
+
+  // The header goes out in the same writev as the records.
+  dstack_snap_header_t header = {DSTACK_SNAP_MAGIC, DSTACK_SNAP_VERSION, 0,
+    stk->record_size, dstack_size(stk)};
+  struct iovec iov[DSTACK_SNAP_IOVECS];
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof(header);
+
+  // A contiguous stack is one more buffer.
+  // A segmented stack is one buffer per segment in use, and a
+  // padded stack is one per record, to leave the padding out.
+  // Either way we hand them over a batch at a time.
+  int count = 1;
+  for (int64_t pos = 0; pos <= stk->pos;) {
+    int64_t num = is_packed(stk) ? run_length(stk, pos, stk->pos + 1) : 1;
+    iov[count].iov_base = calc_ptr(stk, pos);
+    iov[count].iov_len = (size_t) num * stk->record_size;
+    pos += num;
+    if (++count == DSTACK_SNAP_IOVECS) {
+      if (write_all(fd, iov, count)) return -1;
+      count = 0;
+    }
+  }
+  if (count && write_all(fd, iov, count)) return -1;
+  errno = 0;
+  return 0;
+}
+
+int dstack_load(dstack_t* stk, int fd) {
+  // Check error conditions.
+  sanity_check(stk);
+  dstack_snap_header_t header;
+  if (read_all(fd, &header, sizeof(header))) return -1;
+  if (header.magic != DSTACK_SNAP_MAGIC || header.version != DSTACK_SNAP_VERSION
+      || header.record_size != stk->record_size) {
+    errno = EINVAL;
+    return -1;
+  } else if (header.count > (uint64_t) (max_capacity(stk) - stk->pos - 1)) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // Make room for everything up front.
+  int64_t target = stk->pos + 1, needed = target + (int64_t) header.count;
+  if (needed > stk->capacity && extend_stack(stk, needed)) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // Read straight into our storage, a segment at a time if we're
+  // segmented. Nothing is published until every record is in.
+  for (int64_t pos = target; pos < needed;) {
+    int64_t num = run_length(stk, pos, needed);
+    char* run = (char*) calc_ptr(stk, pos);
+    if (read_all(fd, run, (size_t) num * stk->record_size)) return -1;
+
+    // Padded records arrive packed at the front of their run, so
+    // spread them out, last first so nothing is overwritten early.
+    if (!is_packed(stk)) {
+      for (int64_t i = num - 1; i > 0; --i) {
+        memmove(run + record_offset(stk, i), run + (size_t) i * stk->record_size, stk->record_size);
+      }
+    }
+    pos += num;
+  }
+
+  // Publish and return.
+  stk->pos = needed - 1;
+  STKSTATS_PUSH(stk->stats, header.count, needed);
+  errno = 0;
+  return 0;
+}
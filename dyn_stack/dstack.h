@@ -7,31 +7,197 @@
 #include <stddef.h>
 #include <inttypes.h>
 
+/*----- Project Includes -----*/
+
+#include "../stats/stkstats.h"
+
 /*----- Numerical Constants -----*/
 
-#define DSTACK_SIZE        (4096)
 #define DSTACK_BASE        (-1)
 
+// Bytes of header at the start of a mapped stack's file,
+// the records follow straight after.
+#define DSTACK_FILE_HEADER (64)
+
+// The largest record alignment a stack can ask for, a page.
+// Mapped stacks can ask for at most DSTACK_FILE_HEADER.
+#define DSTACK_MAX_ALIGN   (4096)
+
 /*----- Type Declarations -----*/
 
+// Result of the errno-free stack operations.
+typedef enum dstack_status {
+  DSTACK_OK,
+  DSTACK_EMPTY,         // Same as ENOENT
+  DSTACK_NOMEM,         // Same as ENOMEM
+  DSTACK_INVALID        // Same as EINVAL
+} dstack_status_t;
+
+// How the stack grows its buffer once it fills up.
+typedef enum dstack_growth {
+  DSTACK_GROW_DOUBLE,   // Multiply capacity by 2
+  DSTACK_GROW_HALF,     // Multiply capacity by 1.5
+  DSTACK_GROW_CHUNK     // Add a fixed number of records
+} dstack_growth_t;
+
+// How the stack lays out its records in memory.
+// A contiguous stack keeps one buffer and reallocates it on
+// growth, which can move every record.
+// A segmented stack keeps a directory of fixed-size segments
+// and allocates a new one on growth, so records never move
+// and pointers returned by dstack_peek stay valid until the
+// record is popped.
+// A mapped stack keeps its records in a file, mapped contiguously
+// into memory, and grows by extending the file. It can only be
+// created through dstack_open.
+typedef enum dstack_storage {
+  DSTACK_STORAGE_CONTIGUOUS,
+  DSTACK_STORAGE_SEGMENTED,
+  DSTACK_STORAGE_MAPPED
+} dstack_storage_t;
+
+// Where the stack gets its memory from.
+// Every call gets ctx back, along with the size of the block
+// being resized or freed, so that allocators which don't track
+// sizes themselves, like arenas and mmap, don't have to.
+// align is a power of two the block must be aligned to, or zero
+// for whatever malloc would give, and realloc must keep it.
+typedef struct dstack_allocator {
+  void* (*alloc) (void* ctx, size_t len, size_t align);
+  void* (*realloc) (void* ctx, void* ptr, size_t old_len, size_t new_len, size_t align);
+  void (*free) (void* ctx, void* ptr, size_t len);
+  void* ctx;
+} dstack_allocator_t;
+
+// Optional settings for dstack_init_config.
+// Passing NULL gets the same defaults as dstack_init.
+typedef struct dstack_config {
+  dstack_growth_t growth;
+  int64_t chunk;        // Records per chunk, for DSTACK_GROW_CHUNK
+  dstack_storage_t storage;
+  int shrink;           // Halve the buffer when under a quarter full
+  dstack_allocator_t const* allocator;    // NULL for dstack_libc_allocator
+  size_t align;         // Record alignment, a power of two, or zero for none
+} dstack_config_t;
+
+// Records are stride bytes apart, which is record_size rounded up
+// to the requested alignment. When stride is a power of two,
+// stride_shift is its log, and is -1 otherwise.
+// reserved is the capacity last asked for by dstack_reserve, which
+// auto-shrinking never goes below.
 typedef struct dynamic_stack {
-  int64_t pos, capacity;
-  size_t record_size;
+  int64_t pos, capacity, reserved;
+  size_t record_size, stride, align;
+  int stride_shift;
+  dstack_growth_t growth;
+  int64_t chunk;
+  dstack_storage_t storage;
+  int shrink;
+  dstack_allocator_t allocator;
+
+  // Contiguous storage.
+  // For mapped storage, buffer points just past the file header
+  // at the start of map.
   void* buffer;
+  void* map;
+  int fd;
+
+  // Segmented storage.
+  // Each segment holds (1 << seg_shift) records.
+  void** segments;
+  int64_t directory;
+  unsigned seg_shift;
+
   void (*destroy) (void*);
+
+#ifdef STACK_STATS
+  // Hot path counters, NULL if they couldn't be allocated.
+  stkstats_t* stats;
+#endif
 } dstack_t;
 
+/*----- Globals -----*/
+
+// Allocates through malloc, realloc and free.
+extern dstack_allocator_t const dstack_libc_allocator;
+
 /*----- Function Declarations -----*/
 
 // Lifecycle functions
 int dstack_init(dstack_t* stk, size_t record_size, void (*destroy) (void*));
+int dstack_init_config(dstack_t* stk, size_t record_size,
+    void (*destroy) (void*), dstack_config_t const* config);
 void dstack_destroy(dstack_t* stk);
 
+// Persistent stacks
+// dstack_open maps the stack stored in the file at path, creating
+// it if it doesn't exist. Reopening maps the records where they
+// are, so it takes the same time however large the stack is.
+// Fails with EINVAL if the file holds a stack of another record
+// size or stride, or isn't a stack at all, or if config asks for
+// an alignment over DSTACK_FILE_HEADER. The allocator and storage
+// settings in config are ignored.
+// dstack_sync records the current size in the file header and
+// flushes the mapping to disk. dstack_destroy records the size of
+// a mapped stack too, and then unmaps it without popping anything,
+// so the records are there next time it's opened.
+int dstack_open(dstack_t* stk, char const* path, size_t record_size,
+    void (*destroy) (void*), dstack_config_t const* config);
+int dstack_sync(dstack_t* stk);
+
+// Snapshots
+// dstack_save writes a versioned snapshot of every record to fd,
+// straight out of the stack's storage in a single writev.
+// dstack_load reads a snapshot from fd and pushes its records on
+// top of an initialized stack, straight into its storage. It fails
+// with EINVAL if the snapshot is malformed or was taken from a stack
+// with a different record size, and pushes nothing if it fails.
+// Records are copied byte for byte, so records holding pointers
+// only make sense to reload in the same process. Snapshots store
+// records packed, so they load into stacks of any alignment.
+int dstack_save(dstack_t* stk, int fd);
+int dstack_load(dstack_t* stk, int fd);
+
 // Stack operations
 int dstack_push(dstack_t* stk, void const* val);
 void* dstack_peek(dstack_t* stk);
 int dstack_pop(dstack_t* stk);
 size_t dstack_size(dstack_t const* stk);
 size_t dstack_capacity(dstack_t const* stk);
+size_t dstack_stride(dstack_t const* stk);
+
+// Errno-free stack operations
+// These report errors through their return value only, and never
+// write errno themselves. The allocator may still set it when
+// dstack_try_push fails to grow the stack.
+dstack_status_t dstack_try_push(dstack_t* stk, void const* val);
+dstack_status_t dstack_try_peek(dstack_t* stk, void** out);
+dstack_status_t dstack_try_pop(dstack_t* stk);
+
+// Capacity management
+// dstack_reserve grows the stack to hold at least count records,
+// and keeps auto-shrinking from giving that capacity back.
+// dstack_shrink_to_fit releases all capacity that isn't in use,
+// reserved or not.
+int dstack_reserve(dstack_t* stk, size_t count);
+int dstack_shrink_to_fit(dstack_t* stk);
+
+// Batch operations
+// These do a single capacity check and a single copy
+// for the whole batch of records.
+// For a segmented stack, dstack_peek_n fails with ERANGE
+// if the requested records straddle a segment boundary.
+// Records in the batch handed to dstack_push_n are packed
+// record_size apart, but the view dstack_peek_n returns is
+// laid out like the stack, dstack_stride bytes apart.
+int dstack_push_n(dstack_t* stk, void const* vals, size_t count);
+void* dstack_peek_n(dstack_t* stk, size_t count);
+int dstack_pop_n(dstack_t* stk, size_t count);
+
+// Statistics
+// dstack_stats copies out the stack's counters. It fails with
+// ENOTSUP unless the stack was built with STACK_STATS, and
+// managed to register its counters.
+int dstack_stats(dstack_t const* stk, stkstats_t* out);
 
 #endif
@@ -0,0 +1,63 @@
+#ifndef DSTACK_INLINE_H
+#define DSTACK_INLINE_H
+
+/*----- System Includes -----*/
+
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "dstack.h"
+
+/*----- Function Implementations -----*/
+
+// Opt-in inline versions of the hot stack operations.
+// Each one handles the common case, a contiguous or mapped stack
+// that doesn't need to grow, shrink or destroy anything, right
+// here in the caller, where the compiler can see through the copy
+// and the returned pointer. Everything else falls back to the
+// out of line operation in dstack.c, which is also where growth
+// lives.
+//
+// Like the typed stacks, the fast path leaves errno alone on
+// success, so only check errno after a failure.
+
+inline static void* dstack_at_inline(dstack_t* stk, int64_t pos) {
+  // Same as calc_ptr in dstack.c, for storage with a buffer.
+  size_t offset = stk->stride_shift >= 0 ?
+    (size_t) pos << stk->stride_shift : (size_t) pos * stk->stride;
+  return (char*) stk->buffer + offset;
+}
+
+inline static int dstack_push_inline(dstack_t* stk, void const* val) {
+  int64_t target = stk->pos + 1;
+  if (target < stk->capacity && val && stk->storage != DSTACK_STORAGE_SEGMENTED) {
+    memcpy(dstack_at_inline(stk, target), val, stk->record_size);
+    stk->pos = target;
+    STKSTATS_PUSH(stk->stats, 1, target + 1);
+    return 0;
+  }
+  return dstack_push(stk, val);
+}
+
+inline static void* dstack_peek_inline(dstack_t* stk) {
+  if (stk->pos >= 0 && stk->storage != DSTACK_STORAGE_SEGMENTED) {
+    return dstack_at_inline(stk, stk->pos);
+  }
+  return dstack_peek(stk);
+}
+
+inline static int dstack_pop_inline(dstack_t* stk) {
+  if (stk->pos >= 0 && !stk->destroy && !stk->shrink) {
+    --stk->pos;
+    STKSTATS_POP(stk->stats, 1, stk->pos + 1);
+    return 0;
+  }
+  return dstack_pop(stk);
+}
+
+inline static size_t dstack_size_inline(dstack_t const* stk) {
+  return stk->pos + 1;
+}
+
+#endif
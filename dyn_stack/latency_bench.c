@@ -0,0 +1,78 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "dstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_RECORDS       (10000000LL)
+#define RECORD_SIZE           (64)
+
+/*----- Function Implementations -----*/
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compare_u64(void const* lhs, void const* rhs) {
+  uint64_t a = *(uint64_t const*) lhs, b = *(uint64_t const*) rhs;
+  return (a > b) - (a < b);
+}
+
+static int run(char const* name, dstack_storage_t storage, int64_t records, uint64_t* samples) {
+  dstack_config_t config = {DSTACK_GROW_DOUBLE, 0, storage};
+  dstack_t stk;
+  if (dstack_init_config(&stk, RECORD_SIZE, NULL, &config)) {
+    perror("dstack_init_config");
+    return -1;
+  }
+
+  // Time every push individually, so that growth shows
+  // up in the tail rather than being averaged away.
+  char record[RECORD_SIZE];
+  memset(record, 0xab, sizeof(record));
+  for (int64_t i = 0; i < records; ++i) {
+    uint64_t start = now_ns();
+    if (dstack_push(&stk, record)) {
+      perror("dstack_push");
+      return -1;
+    }
+    samples[i] = now_ns() - start;
+  }
+  dstack_destroy(&stk);
+
+  qsort(samples, records, sizeof(*samples), compare_u64);
+  printf("storage=%s records=%" PRId64 " p50_ns=%" PRIu64 " p99_ns=%" PRIu64
+      " p999_ns=%" PRIu64 " max_ns=%" PRIu64 "\n", name, records,
+      samples[records / 2], samples[records / 100 * 99],
+      samples[records / 1000 * 999], samples[records - 1]);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  // Usage: latency_bench [records]
+  int64_t records = DEFAULT_RECORDS;
+  if (argc >= 2) records = strtoll(argv[1], NULL, 10);
+  if (records < 1000) records = 1000;
+
+  uint64_t* samples = malloc(sizeof(uint64_t) * records);
+  if (!samples) {
+    perror("malloc");
+    return 1;
+  }
+
+  int err = run("contiguous", DSTACK_STORAGE_CONTIGUOUS, records, samples);
+  if (!err) err = run("segmented", DSTACK_STORAGE_SEGMENTED, records, samples);
+  free(samples);
+  return err ? 1 : 0;
+}
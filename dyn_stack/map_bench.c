@@ -0,0 +1,90 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "dstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_RECORDS       (10000000LL)
+#define DEFAULT_PATH          "map_bench.map"
+#define BATCH                 (4096)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+  // Usage: map_bench [records] [path]
+  int64_t records = DEFAULT_RECORDS;
+  char const* path = DEFAULT_PATH;
+  if (argc >= 2) records = strtoll(argv[1], NULL, 10);
+  if (argc >= 3) path = argv[2];
+
+  // Build a persistent stack, and the same records in a plain file
+  // for comparison.
+  remove(path);
+  dstack_t stk;
+  if (dstack_open(&stk, path, sizeof(int64_t), NULL, NULL)) {
+    perror("dstack_open");
+    return EXIT_FAILURE;
+  }
+  double start = now();
+  for (int64_t i = 0; i < records; ++i) dstack_push(&stk, &i);
+  dstack_sync(&stk);
+  double build = now() - start;
+  dstack_destroy(&stk);
+
+  // Cold start by mapping the stack where it is.
+  start = now();
+  if (dstack_open(&stk, path, sizeof(int64_t), NULL, NULL)) {
+    perror("dstack_open");
+    return EXIT_FAILURE;
+  }
+  int64_t top = *(int64_t*) dstack_peek(&stk);
+  double reopen = now() - start;
+  dstack_destroy(&stk);
+
+  // Cold start by reading every record back into a fresh stack,
+  // which is what we'd have to do without the mapping.
+  start = now();
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    perror("fopen");
+    return EXIT_FAILURE;
+  }
+  dstack_t copy;
+  dstack_init(&copy, sizeof(int64_t), NULL);
+  dstack_reserve(&copy, records);
+  int64_t batch[BATCH];
+  fseek(file, DSTACK_FILE_HEADER, SEEK_SET);
+  for (int64_t left = records; left > 0;) {
+    size_t count = fread(batch, sizeof(int64_t), left < BATCH ? left : BATCH, file);
+    if (!count) break;
+    dstack_push_n(&copy, batch, count);
+    left -= count;
+  }
+  fclose(file);
+  int64_t copied = *(int64_t*) dstack_peek(&copy);
+  double reload = now() - start;
+  dstack_destroy(&copy);
+  remove(path);
+
+  if (top != records - 1 || copied != records - 1) {
+    fprintf(stderr, "Records came back wrong\n");
+    return EXIT_FAILURE;
+  }
+  printf("%lld records: build %.4fs, reopen %.6fs, reload %.4fs\n",
+      (long long) records, build, reopen, reload);
+  return EXIT_SUCCESS;
+}
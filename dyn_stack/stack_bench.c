@@ -0,0 +1,77 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+/*----- Project Includes -----*/
+
+#include "dstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_RECORDS       (100000000LL)
+#define DEFAULT_CHUNK         (1 << 20)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long peak_rss_kb(void) {
+  // On Linux ru_maxrss is reported in kilobytes.
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+int main(int argc, char** argv) {
+  // Usage: stack_bench [records] [double|half|chunk] [chunk size]
+  // Peak RSS is process-wide, so we measure a single policy per run.
+  int64_t records = DEFAULT_RECORDS;
+  dstack_config_t config = {DSTACK_GROW_DOUBLE, DEFAULT_CHUNK};
+  if (argc >= 2) records = strtoll(argv[1], NULL, 10);
+  if (argc >= 3) {
+    if (!strcmp(argv[2], "half")) config.growth = DSTACK_GROW_HALF;
+    else if (!strcmp(argv[2], "chunk")) config.growth = DSTACK_GROW_CHUNK;
+    else if (strcmp(argv[2], "double")) {
+      fprintf(stderr, "Unknown growth policy \"%s\"\n", argv[2]);
+      return 1;
+    }
+  }
+  if (argc >= 4) config.chunk = strtoll(argv[3], NULL, 10);
+
+  dstack_t stk;
+  if (dstack_init_config(&stk, sizeof(int64_t), NULL, &config)) {
+    perror("dstack_init_config");
+    return 1;
+  }
+
+  // Push everything, timing the whole run.
+  double start = now();
+  for (int64_t val = 0; val < records; ++val) {
+    if (dstack_push(&stk, &val)) {
+      perror("dstack_push");
+      return 1;
+    }
+  }
+  double elapsed = now() - start;
+
+  // Make sure the work can't be optimized away.
+  if (*(int64_t*) dstack_peek(&stk) != records - 1) return 1;
+
+  printf("policy=%s records=%" PRId64 " capacity=%zu seconds=%.3f "
+      "mpush_per_sec=%.1f peak_rss_mb=%.1f\n",
+      argc >= 3 ? argv[2] : "double", records, dstack_capacity(&stk),
+      elapsed, records / elapsed / 1e6, peak_rss_kb() / 1024.0);
+
+  dstack_destroy(&stk);
+  return 0;
+}
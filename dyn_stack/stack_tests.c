@@ -1,18 +1,34 @@
 /*----- System Includes -----*/
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 
 /*----- Project Includes -----*/
 
+#include "../prng/prng.h"
 #include "dstack.h"
+#include "dstack_inline.h"
+#include "dalloc.h"
+#include "dspill.h"
 
 /*----- Numerical Constants -----*/
 
+#define SEED              (42)
 #define STR_LEN           (8)
 #define MAX_STRING        (16)
 #define NUM_STRINGS       (16)
+#define NUM_RECORDS       (10000)
+#define MAP_PATH          "stack_tests.map"
+#define SNAP_PATH         "stack_tests.snap"
+#define SPILL_BUDGET      (100)
+#define ALIGN             (64)
+#define RECORD_BYTES      (24)
 
 /*----- Type Declarations -----*/
 
@@ -21,22 +37,19 @@ typedef struct string {
   size_t len;
 } string_t;
 
+/*----- Globals -----*/
+
+// Seeded the same way every run, so failures reproduce.
+static prng_t rng;
+
 /*----- Function Implementations -----*/
 
 char* rand_string(size_t len) {
-  // Our character set to pull from
-  static char const* alpha = "abcdefghijklmnopqrstuvwxyz";
-
   // Get memory for our string.
   char* str = (char*) malloc(sizeof(char) * (len + 1));
 
-  // Write in our random characters.
-  // XXX: The function rand is a TERRIBLE random number generator
-  // Don't write this code in production
-  char* curr = str;
-  while (curr - str < len) {
-    *curr++ = alpha[rand() % 26];
-  }
+  // Write in our random characters, up to thirteen per draw.
+  prng_alpha(&rng, str, len);
 
   // Terminate our string and return.
   str[len] = '\0';
@@ -48,7 +61,16 @@ void destroy_string(void* ptr) {
   free(str->str);
 }
 
+void* refuse_realloc(void* ctx, void* ptr, size_t old_len, size_t new_len, size_t align) {
+  // Stands in for an allocator that's out of memory, and
+  // doesn't say so through errno.
+  (void) ctx, (void) ptr, (void) old_len, (void) new_len, (void) align;
+  return NULL;
+}
+
 int main() {
+  prng_seed(&rng, SEED);
+
   // Initialize a stack.
   dstack_t stk;
   dstack_init(&stk, sizeof(string_t), destroy_string);
@@ -84,7 +106,387 @@ int main() {
   assert(!dstack_peek(&stk));
   assert(errno == ENOENT);
 
-  // Cleanup and exit.
+  // Push a fresh set of strings as a single batch.
+  for (int i = 0; i < NUM_STRINGS; i++) strs[i].str = rand_string(STR_LEN);
+  int err = dstack_push_n(&stk, strs, NUM_STRINGS);
+  assert(!err);
+  assert(dstack_size(&stk) == NUM_STRINGS);
+  assert(dstack_capacity(&stk) >= NUM_STRINGS);
+
+  // The batch view should match what we pushed, and
+  // should end with the record on top of the stack.
+  string_t* view = (string_t*) dstack_peek_n(&stk, NUM_STRINGS);
+  assert(!memcmp(view, strs, sizeof(strs)));
+  assert(&view[NUM_STRINGS - 1] == dstack_peek(&stk));
+  assert(!dstack_peek_n(&stk, NUM_STRINGS + 1));
+  assert(errno == ENOENT);
+
+  // Pop the batch off in two halves.
+  // The destructor runs over every popped record.
+  err = dstack_pop_n(&stk, NUM_STRINGS / 2);
+  assert(!err);
+  string_t const* top = (string_t const*) dstack_peek(&stk);
+  assert(!memcmp(top, &strs[NUM_STRINGS / 2 - 1], sizeof(string_t)));
+  err = dstack_pop_n(&stk, NUM_STRINGS / 2);
+  assert(!err && !dstack_size(&stk));
+  assert(dstack_pop_n(&stk, 1) && errno == ENOENT);
+
+  // The errno-free variants report the same conditions
+  // through their return values, and leave errno alone.
+  errno = 0;
+  void* peeked;
+  assert(dstack_try_pop(&stk) == DSTACK_EMPTY);
+  assert(dstack_try_peek(&stk, &peeked) == DSTACK_EMPTY);
+  assert(dstack_try_push(&stk, NULL) == DSTACK_INVALID);
+  for (int i = 0; i < NUM_STRINGS; i++) {
+    strs[i].str = rand_string(STR_LEN);
+    assert(dstack_try_push(&stk, &strs[i]) == DSTACK_OK);
+  }
+  assert(dstack_try_peek(&stk, &peeked) == DSTACK_OK);
+  assert(!memcmp(peeked, &strs[NUM_STRINGS - 1], sizeof(string_t)));
+  while (dstack_try_pop(&stk) == DSTACK_OK);
+  assert(!dstack_size(&stk));
+  assert(errno == 0);
+
+  // Cleanup.
   dstack_destroy(&stk);
+
+  // Make sure every growth policy can grow well past
+  // the initial capacity, and keeps records intact.
+  dstack_config_t configs[] = {
+    {DSTACK_GROW_DOUBLE, 0},
+    {DSTACK_GROW_HALF, 0},
+    {DSTACK_GROW_CHUNK, 100},
+    {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_SEGMENTED}
+  };
+  for (size_t i = 0; i < sizeof(configs) / sizeof(*configs); ++i) {
+    dstack_t nums;
+    err = dstack_init_config(&nums, sizeof(int64_t), NULL, &configs[i]);
+    assert(!err);
+    for (int64_t val = 0; val < NUM_RECORDS; ++val) {
+      err = dstack_push(&nums, &val);
+      assert(!err);
+    }
+    assert(dstack_size(&nums) == NUM_RECORDS);
+    assert(dstack_capacity(&nums) >= NUM_RECORDS);
+    for (int64_t val = NUM_RECORDS - 1; val >= 0; --val) {
+      assert(*(int64_t*) dstack_peek(&nums) == val);
+      dstack_pop(&nums);
+    }
+    dstack_destroy(&nums);
+  }
+
+  // Every allocator should work with both storage modes.
+  arena_t arena;
+  err = arena_init(&arena, ARENA_MALLOC, 0);
+  assert(!err);
+  dstack_allocator_t allocators[] = {
+    dstack_libc_allocator,
+    dalloc_arena(&arena),
+    dalloc_mmap(DALLOC_HUGE_NONE),
+    dalloc_mmap(DALLOC_HUGE_TLB)
+  };
+  for (size_t i = 0; i < sizeof(allocators) / sizeof(*allocators); ++i) {
+    for (int storage = DSTACK_STORAGE_CONTIGUOUS; storage <= DSTACK_STORAGE_SEGMENTED; ++storage) {
+      dstack_config_t config = {DSTACK_GROW_DOUBLE, 0, storage, 1, &allocators[i]};
+      dstack_t nums;
+      err = dstack_init_config(&nums, sizeof(int64_t), NULL, &config);
+      assert(!err);
+      for (int64_t val = 0; val < NUM_RECORDS; ++val) {
+        err = dstack_push(&nums, &val);
+        assert(!err);
+      }
+      for (int64_t val = NUM_RECORDS - 1; val >= 0; --val) {
+        assert(*(int64_t*) dstack_peek(&nums) == val);
+        dstack_pop(&nums);
+      }
+      dstack_destroy(&nums);
+    }
+  }
+
+  // And so should aligned records, which have to come back aligned,
+  // padded out to the alignment, and intact.
+  for (size_t i = 0; i < sizeof(allocators) / sizeof(*allocators); ++i) {
+    for (int storage = DSTACK_STORAGE_CONTIGUOUS; storage <= DSTACK_STORAGE_SEGMENTED; ++storage) {
+      dstack_config_t config = {DSTACK_GROW_DOUBLE, 0, storage, 0, &allocators[i], ALIGN};
+      dstack_t records;
+      err = dstack_init_config(&records, RECORD_BYTES, NULL, &config);
+      assert(!err && dstack_stride(&records) == ALIGN);
+      char record[RECORD_BYTES], packed[RECORD_BYTES * NUM_STRINGS];
+      for (int val = 0; val < NUM_RECORDS; ++val) {
+        memset(record, val, RECORD_BYTES);
+        err = dstack_push(&records, record);
+        assert(!err);
+        assert((uintptr_t) dstack_peek(&records) % ALIGN == 0);
+      }
+      for (int j = 0; j < NUM_STRINGS; ++j) memset(packed + j * RECORD_BYTES, j, RECORD_BYTES);
+      err = dstack_push_n(&records, packed, NUM_STRINGS);
+      assert(!err);
+      for (int j = NUM_STRINGS - 1; j >= 0; --j) {
+        memset(record, j, RECORD_BYTES);
+        assert(!memcmp(dstack_peek(&records), record, RECORD_BYTES));
+        dstack_pop(&records);
+      }
+      for (int val = NUM_RECORDS - 1; val >= 0; --val) {
+        memset(record, val, RECORD_BYTES);
+        assert(!memcmp(dstack_peek(&records), record, RECORD_BYTES));
+        dstack_pop(&records);
+      }
+      dstack_destroy(&records);
+    }
+  }
+  arena_destroy(&arena);
+
+  // Alignments have to be powers of two.
+  dstack_config_t misaligned = {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_CONTIGUOUS, 0, NULL, 24};
+  dstack_t unused;
+  assert(dstack_init_config(&unused, RECORD_BYTES, NULL, &misaligned) && errno == EINVAL);
+
+  // A chunked policy without a chunk size is invalid.
+  dstack_config_t bad = {DSTACK_GROW_CHUNK, 0};
+  dstack_t nums;
+  assert(dstack_init_config(&nums, sizeof(int64_t), NULL, &bad) && errno == EINVAL);
+
+  // Records in a segmented stack should never move as it grows.
+  dstack_config_t segmented = {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_SEGMENTED};
+  err = dstack_init_config(&nums, sizeof(int64_t), NULL, &segmented);
+  assert(!err);
+  int64_t first = 42;
+  dstack_push(&nums, &first);
+  int64_t* bottom = (int64_t*) dstack_peek(&nums);
+  int64_t batch[NUM_RECORDS];
+  for (int64_t i = 0; i < NUM_RECORDS; ++i) batch[i] = i;
+  err = dstack_push_n(&nums, batch, NUM_RECORDS);
+  assert(!err);
+  assert(*bottom == first);
+
+  // A view across a segment boundary can't be contiguous,
+  // but batch pops work across segments.
+  assert(!dstack_peek_n(&nums, NUM_RECORDS) && errno == ERANGE);
+  assert(*(int64_t*) dstack_peek(&nums) == NUM_RECORDS - 1);
+  err = dstack_pop_n(&nums, NUM_RECORDS);
+  assert(!err);
+  assert(dstack_peek(&nums) == bottom);
+  dstack_destroy(&nums);
+
+  // An auto-shrinking stack should give memory back as it drains,
+  // but shouldn't thrash when hovering around a boundary.
+  dstack_config_t shrinking = {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_CONTIGUOUS, 1};
+  err = dstack_init_config(&nums, sizeof(int64_t), NULL, &shrinking);
+  assert(!err);
+  err = dstack_push_n(&nums, batch, NUM_RECORDS);
+  assert(!err);
+  size_t peak = dstack_capacity(&nums);
+  err = dstack_pop_n(&nums, NUM_RECORDS - NUM_STRINGS);
+  assert(!err);
+  size_t drained = dstack_capacity(&nums);
+  assert(drained < peak && drained >= NUM_STRINGS);
+  for (int i = 0; i < NUM_STRINGS; ++i) {
+    dstack_push(&nums, &batch[0]);
+    dstack_pop(&nums);
+    assert(dstack_capacity(&nums) == drained);
+  }
+  assert(*(int64_t*) dstack_peek(&nums) == NUM_STRINGS - 1);
+
+  // Reserving should let a burst in without growing again,
+  // and shrinking to fit should release all slack.
+  err = dstack_reserve(&nums, NUM_RECORDS);
+  assert(!err && dstack_capacity(&nums) == NUM_RECORDS);
+  dstack_pop(&nums);
+  assert(dstack_capacity(&nums) == NUM_RECORDS);
+  dstack_push(&nums, &batch[NUM_STRINGS - 1]);
+  void* buffer = nums.buffer;
+  err = dstack_push_n(&nums, batch, NUM_RECORDS - NUM_STRINGS);
+  assert(!err && nums.buffer == buffer);
+  assert(dstack_capacity(&nums) == NUM_RECORDS);
+  err = dstack_shrink_to_fit(&nums);
+  assert(!err && dstack_capacity(&nums) == dstack_size(&nums));
+  dstack_destroy(&nums);
+
+  // Segmented stacks release whole segments.
+  segmented.shrink = 1;
+  err = dstack_init_config(&nums, sizeof(int64_t), NULL, &segmented);
+  assert(!err);
+  size_t segment = dstack_capacity(&nums);
+  err = dstack_reserve(&nums, segment * 8);
+  assert(!err && dstack_capacity(&nums) == segment * 8);
+  err = dstack_shrink_to_fit(&nums);
+  assert(!err && dstack_capacity(&nums) == segment);
+  err = dstack_push_n(&nums, batch, NUM_RECORDS);
+  assert(!err);
+  err = dstack_pop_n(&nums, NUM_RECORDS);
+  assert(!err && dstack_capacity(&nums) == segment * 2);
+  err = dstack_reserve(&nums, segment * 4);
+  assert(!err);
+  dstack_push(&nums, &batch[0]);
+  dstack_pop(&nums);
+  assert(dstack_capacity(&nums) == segment * 4);
+  dstack_destroy(&nums);
+
+  // Failing to resize should always say why.
+  dstack_allocator_t refusing = dstack_libc_allocator;
+  refusing.realloc = refuse_realloc;
+  dstack_config_t stingy = {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_CONTIGUOUS, 0, &refusing};
+  err = dstack_init_config(&nums, sizeof(int64_t), NULL, &stingy);
+  assert(!err);
+  errno = 0;
+  assert(dstack_reserve(&nums, NUM_RECORDS) && errno == ENOMEM);
+  errno = 0;
+  assert(dstack_shrink_to_fit(&nums) && errno == ENOMEM);
+  dstack_destroy(&nums);
+
+  // A mapped stack should keep its records across a reopen.
+  remove(MAP_PATH);
+  err = dstack_open(&nums, MAP_PATH, sizeof(int64_t), NULL, NULL);
+  assert(!err && !dstack_size(&nums));
+  err = dstack_push_n(&nums, batch, NUM_RECORDS);
+  assert(!err && dstack_capacity(&nums) >= NUM_RECORDS);
+  err = dstack_sync(&nums);
+  assert(!err);
+  dstack_pop_n(&nums, NUM_STRINGS);
+  dstack_destroy(&nums);
+  err = dstack_open(&nums, MAP_PATH, sizeof(int64_t), NULL, NULL);
+  assert(!err && dstack_size(&nums) == NUM_RECORDS - NUM_STRINGS);
+  int64_t* records = (int64_t*) dstack_peek_n(&nums, dstack_size(&nums));
+  for (int64_t i = 0; i < NUM_RECORDS - NUM_STRINGS; ++i) assert(records[i] == i);
+
+  // Mapped stacks honor the shrink settings like any other.
+  err = dstack_shrink_to_fit(&nums);
+  assert(!err && dstack_capacity(&nums) == NUM_RECORDS - NUM_STRINGS);
+  dstack_destroy(&nums);
+  err = dstack_open(&nums, MAP_PATH, sizeof(int64_t), NULL, NULL);
+  assert(!err && dstack_capacity(&nums) == NUM_RECORDS - NUM_STRINGS);
+  assert(*(int64_t*) dstack_peek(&nums) == NUM_RECORDS - NUM_STRINGS - 1);
+  dstack_destroy(&nums);
+
+  // Opening with the wrong record size, or something that isn't a
+  // stack at all, should fail.
+  assert(dstack_open(&nums, MAP_PATH, sizeof(int32_t), NULL, NULL) && errno == EINVAL);
+  dstack_config_t wide = {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_CONTIGUOUS, 0, NULL, ALIGN};
+  assert(dstack_open(&nums, MAP_PATH, sizeof(int64_t), NULL, &wide) && errno == EINVAL);
+  wide.align = DSTACK_FILE_HEADER * 2;
+  assert(dstack_open(&nums, MAP_PATH, sizeof(int64_t), NULL, &wide) && errno == EINVAL);
+  FILE* junk = fopen(MAP_PATH, "wb");
+  assert(junk);
+  fwrite(batch, sizeof(int64_t), NUM_STRINGS, junk);
+  fclose(junk);
+  assert(dstack_open(&nums, MAP_PATH, sizeof(int64_t), NULL, NULL) && errno == EINVAL);
+  dstack_config_t mapped = {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_MAPPED};
+  assert(dstack_init_config(&nums, sizeof(int64_t), NULL, &mapped) && errno == EINVAL);
+  remove(MAP_PATH);
+
+  // A new file that can't be mapped shouldn't be left behind to
+  // break the next open.
+  assert(dstack_open(&nums, MAP_PATH, (size_t) 1 << 56, NULL, NULL));
+  assert(access(MAP_PATH, F_OK));
+  err = dstack_open(&nums, MAP_PATH, sizeof(int64_t), NULL, NULL);
+  assert(!err && !dstack_size(&nums));
+  dstack_destroy(&nums);
+  remove(MAP_PATH);
+
+  // Snapshots should round trip between every storage mode, and
+  // land on top of whatever the stack already holds.
+  dstack_config_t modes[] = {
+    {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_CONTIGUOUS},
+    {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_SEGMENTED},
+    {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_CONTIGUOUS, 0, NULL, ALIGN},
+    {DSTACK_GROW_DOUBLE, 0, DSTACK_STORAGE_SEGMENTED, 0, NULL, ALIGN}
+  };
+  int num_modes = sizeof(modes) / sizeof(*modes);
+  for (int from = 0; from < num_modes; ++from) {
+    for (int to = 0; to < num_modes; ++to) {
+      int fd = open(SNAP_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+      assert(fd >= 0);
+      dstack_t saved, loaded;
+      err = dstack_init_config(&saved, sizeof(int64_t), NULL, &modes[from]);
+      assert(!err);
+      err = dstack_init_config(&loaded, sizeof(int64_t), NULL, &modes[to]);
+      assert(!err);
+      err = dstack_push_n(&saved, batch, NUM_RECORDS);
+      assert(!err);
+      err = dstack_save(&saved, fd);
+      assert(!err);
+      dstack_push(&loaded, &first);
+      lseek(fd, 0, SEEK_SET);
+      err = dstack_load(&loaded, fd);
+      assert(!err && dstack_size(&loaded) == NUM_RECORDS + 1);
+      for (int64_t i = NUM_RECORDS - 1; i >= 0; --i) {
+        assert(*(int64_t*) dstack_peek(&loaded) == i);
+        dstack_pop(&loaded);
+      }
+      assert(*(int64_t*) dstack_peek(&loaded) == first);
+
+      // A snapshot of other records, or a truncated one, pushes nothing.
+      dstack_t other;
+      dstack_init(&other, sizeof(int32_t), NULL);
+      lseek(fd, 0, SEEK_SET);
+      assert(dstack_load(&other, fd) && errno == EINVAL && !dstack_size(&other));
+      dstack_destroy(&other);
+      err = ftruncate(fd, sizeof(int64_t) * NUM_STRINGS);
+      assert(!err);
+      lseek(fd, 0, SEEK_SET);
+      assert(dstack_load(&loaded, fd) && errno == EINVAL && dstack_size(&loaded) == 1);
+
+      close(fd);
+      dstack_destroy(&saved);
+      dstack_destroy(&loaded);
+    }
+  }
+  remove(SNAP_PATH);
+
+  // A spilling stack should keep no more than its budget in memory,
+  // and give everything back in order.
+  int fd = open(SNAP_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  assert(fd >= 0);
+  dspill_t spill;
+  assert(dspill_init(&spill, sizeof(int64_t), 1, fd) && errno == EINVAL);
+  err = dspill_init(&spill, sizeof(int64_t), SPILL_BUDGET, fd);
+  assert(!err);
+  for (int64_t i = 0; i < NUM_RECORDS; ++i) {
+    err = dspill_push(&spill, &batch[i]);
+    assert(!err);
+    assert(dspill_size(&spill) - dspill_spilled(&spill) <= SPILL_BUDGET);
+  }
+  assert(dspill_size(&spill) == NUM_RECORDS && dspill_spilled(&spill) > 0);
+
+  // Bouncing back and forth across a spill boundary works too.
+  for (int64_t i = NUM_RECORDS - 1; i >= NUM_RECORDS / 2; --i) {
+    assert(*(int64_t*) dspill_peek(&spill) == i);
+    dspill_pop(&spill);
+  }
+  for (int64_t i = NUM_RECORDS / 2; i < NUM_RECORDS; ++i) dspill_push(&spill, &batch[i]);
+  for (int64_t i = NUM_RECORDS - 1; i >= 0; --i) {
+    assert(*(int64_t*) dspill_peek(&spill) == i);
+    err = dspill_pop(&spill);
+    assert(!err);
+  }
+  assert(!dspill_size(&spill) && !dspill_peek(&spill) && errno == ENOENT);
+  dspill_destroy(&spill);
+  close(fd);
+  remove(SNAP_PATH);
+
+  // The inline fast paths agree with the out of line operations,
+  // for every kind of storage, and fall back to them to grow.
+  for (int storage = DSTACK_STORAGE_CONTIGUOUS; storage <= DSTACK_STORAGE_SEGMENTED; ++storage) {
+    dstack_config_t config = {DSTACK_GROW_DOUBLE, 0, storage, 1};
+    dstack_t fast;
+    err = dstack_init_config(&fast, sizeof(int64_t), NULL, &config);
+    assert(!err);
+    for (int64_t i = 0; i < NUM_RECORDS; ++i) {
+      assert(!dstack_push_inline(&fast, &i));
+      assert(*(int64_t*) dstack_peek_inline(&fast) == i);
+      assert(dstack_peek_inline(&fast) == dstack_peek(&fast));
+    }
+    assert(dstack_size_inline(&fast) == NUM_RECORDS);
+    assert(dstack_push_inline(&fast, NULL) && errno == EINVAL);
+    for (int64_t i = NUM_RECORDS - 1; i >= 0; --i) {
+      assert(*(int64_t*) dstack_peek_inline(&fast) == i);
+      assert(!dstack_pop_inline(&fast));
+    }
+    assert(dstack_pop_inline(&fast) && errno == ENOENT);
+    assert(!dstack_peek_inline(&fast));
+    dstack_destroy(&fast);
+  }
+
   return 0;
 }
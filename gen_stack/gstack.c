@@ -1,40 +1,189 @@
 /*----- System Includes -----*/
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
 
 /*----- Project Includes -----*/
 
 #include "gstack.h"
 
+/*----- Numerical Constants -----*/
+
+#define GSTACK_SNAP_MAGIC        (0x50414e534b545347ULL)    // "GSTKSNAP"
+#define GSTACK_SNAP_VERSION      (1)
+#define GSTACK_SNAP_IOVECS       (64)
+
+// glibc's malloc aligns to two words, anything past that
+// needs posix_memalign.
+#define GSTACK_MALLOC_ALIGN      (2 * sizeof(void*))
+
+// The inline buffer is aligned like the gstack_t around it,
+// which is what a structure member is offset by after a char.
+#define GSTACK_LOCAL_ALIGN       (offsetof(struct gstack_align_probe, stk))
+
+/*----- Type Declarations -----*/
+
+// The header at the start of a snapshot, followed by count records
+// ordered bottom to top.
+typedef struct gstack_snap_header {
+  uint64_t magic;
+  uint32_t version, reserved;
+  uint64_t record_size, count;
+} gstack_snap_header_t;
+
+struct gstack_align_probe {
+  char pad;
+  gstack_t stk;
+};
+
 /*----- Function Implementations -----*/
 
 inline static void sanity_check(gstack_t const* stk) {
   // Make sure our basic invariants hold.
-  assert(stk && stk->pos < GSTACK_SIZE && stk->pos >= GSTACK_BASE && stk->max);
+  // A stack whose records are too large to fit inline starts
+  // out with no room at all.
+  assert(stk && stk->pos < stk->max && stk->pos >= GSTACK_BASE);
+  assert(stk->heap || (size_t) stk->max * stk->stride <= GSTACK_INLINE_SIZE);
+}
+
+inline static int is_packed(gstack_t const* stk) {
+  return stk->stride == stk->record_size;
+}
+
+inline static size_t record_offset(gstack_t const* stk, int64_t pos) {
+  // Power of two strides, which is every stride once records are
+  // padded out to a cache line, are a shift rather than a multiply.
+  if (stk->stride_shift >= 0) return (size_t) pos << stk->stride_shift;
+  return (size_t) pos * stk->stride;
+}
+
+inline static char* records(gstack_t* stk) {
+  // Choosing here, rather than keeping a pointer to the inline
+  // buffer, keeps a gstack_t safe to move around in memory.
+  return stk->heap ? stk->heap : stk->local.buffer;
 }
 
 inline static void* calc_ptr(gstack_t* stk, int64_t pos) {
-  return stk->buffer + (pos * stk->record_size);
+  return records(stk) + record_offset(stk, pos);
+}
+
+static char* alloc_records(gstack_t* stk, size_t len) {
+  // Move the records to a new heap buffer, aligned however
+  // our caller asked.
+  void* tmp;
+  if (stk->align <= GSTACK_MALLOC_ALIGN) {
+    tmp = malloc(len);
+  } else if (posix_memalign(&tmp, stk->align, len)) {
+    tmp = NULL;
+  }
+  if (tmp) memcpy(tmp, records(stk), gstack_size(stk) * stk->stride);
+  return (char*) tmp;
+}
+
+static int grow_records(gstack_t* stk, int64_t needed) {
+  // Double until we can hold the requested records, clamping
+  // to the largest buffer we could ever ask for.
+  size_t limit = SIZE_MAX / stk->stride;
+  int64_t max = limit > INT64_MAX ? INT64_MAX : (int64_t) limit;
+  if (needed > max) return -1;
+  int64_t target = stk->max ? stk->max : 1;
+  while (target < needed) target = target > max / 2 ? max : target * 2;
+
+  // The first move out to the heap copies the inline records over,
+  // after that realloc does the copying for us, if it has to.
+  // realloc doesn't know about alignment, so over-aligned stacks
+  // always copy.
+  size_t len = (size_t) target * stk->stride;
+  char* tmp;
+  if (stk->heap && stk->align <= GSTACK_MALLOC_ALIGN) {
+    tmp = (char*) realloc(stk->heap, len);
+    if (!tmp) return -1;
+  } else {
+    tmp = alloc_records(stk, len);
+    if (!tmp) return -1;
+    free(stk->heap);
+  }
+
+  // Publish and return.
+  stk->heap = tmp;
+  stk->max = target;
+  return 0;
+}
+
+inline static int grow_stack(gstack_t* stk, int64_t needed) {
+#ifdef STACK_STATS
+  // Time the growth, and count the bytes that had to be carried
+  // over, which realloc may have managed in place.
+  uint64_t start = stkstats_ticks();
+  size_t moved = stk->heap && stk->align <= GSTACK_MALLOC_ALIGN ?
+    (size_t) stk->max * stk->stride : gstack_size(stk) * stk->stride;
+  int err = grow_records(stk, needed);
+  if (!err) stkstats_grow(stk->stats, moved, stkstats_ticks() - start);
+  return err;
+#else
+  return grow_records(stk, needed);
+#endif
+}
+
+inline static int publish_status(gstack_status_t status) {
+  // Translate a status into the errno convention
+  // used by the rest of the API.
+  switch (status) {
+    case GSTACK_OK:
+      errno = 0;
+      return 0;
+    case GSTACK_EMPTY:
+      errno = ENOENT;
+      break;
+    case GSTACK_FULL:
+      errno = ENOMEM;
+      break;
+    default:
+      errno = EINVAL;
+      break;
+  }
+  return -1;
 }
 
 int gstack_init(gstack_t* stk, size_t record_size) {
-  // Calculate how many records our stack can hold
-  // Integer division will round down and give us a
-  // conservative estimate.
-  int64_t max = GSTACK_SIZE / record_size;
-  if (!max) {
-    // Requested record size is too large, we can't
-    // even fit a single record in the stack.
-    errno = ENOSPC;
+  return gstack_init_aligned(stk, record_size, 0);
+}
+
+int gstack_init_aligned(gstack_t* stk, size_t record_size, size_t align) {
+  // Alignments have to be powers of two, and no more than a page.
+  if (align & (align - 1) || align > GSTACK_MAX_ALIGN) {
+    errno = EINVAL;
     return -1;
   }
 
   // If we were given something, initialize it.
-  if (stk) {
-    stk->max = max;
-    stk->pos = GSTACK_BASE;
+  if (stk && record_size) {
     stk->record_size = record_size;
+    stk->align = align;
+    stk->stride = align ? (record_size + align - 1) & ~(align - 1) : record_size;
+    stk->stride_shift = -1;
+    if (!(stk->stride & (stk->stride - 1))) {
+      stk->stride_shift = 0;
+      while (((size_t) 1 << stk->stride_shift) < stk->stride) ++stk->stride_shift;
+    }
+
+    // Calculate how many records fit inline
+    // Integer division will round down and give us a
+    // conservative estimate. Records too large to fit
+    // at all, or aligned past what the inline buffer can
+    // promise, go straight to the heap on the first push.
+    stk->max = align > GSTACK_LOCAL_ALIGN ? 0 : GSTACK_INLINE_SIZE / stk->stride;
+    stk->pos = GSTACK_BASE;
+    stk->heap = NULL;
+#ifdef STACK_STATS
+    stk->stats = stkstats_register("gstack", record_size);
+#endif
     errno = 0;
     return 0;
   } else {
@@ -44,23 +193,25 @@ int gstack_init(gstack_t* stk, size_t record_size) {
 }
 
 void gstack_destroy(gstack_t* stk) {
-  // Currently a no-op as the stack doesn't
-  // own any resources.
-  (void) stk;
+  // Release the heap buffer, if we ever moved to one.
+  free(stk->heap);
+  stk->heap = NULL;
+#ifdef STACK_STATS
+  stkstats_unregister(stk->stats);
+  stk->stats = NULL;
+#endif
 }
 
-int gstack_push(gstack_t* stk, void const* val) {
+gstack_status_t gstack_try_push(gstack_t* stk, void const* val) {
   // Check error conditions.
   sanity_check(stk);
   int64_t target = stk->pos + 1;
-  if (target == stk->max) {
-    // Stack is full.
-    errno = ENOMEM;
-    return -1;
-  } else if (!val) {
+  if (!val) {
     // User didn't give us a value to push.
-    errno = EINVAL;
-    return -1;
+    return GSTACK_INVALID;
+  } else if (target == stk->max && grow_stack(stk, target + 1)) {
+    // Stack is full, and we couldn't grow it.
+    return GSTACK_FULL;
   }
 
   // Write the value into the stack.
@@ -78,33 +229,115 @@ int gstack_push(gstack_t* stk, void const* val) {
 
   // Publish and return.
   ++stk->pos;
+  STKSTATS_PUSH(stk->stats, 1, target + 1);
+  return GSTACK_OK;
+}
+
+gstack_status_t gstack_try_peek(gstack_t* stk, void** out) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (!out) {
+    return GSTACK_INVALID;
+  } else if (stk->pos < 0) {
+    return GSTACK_EMPTY;
+  }
+
+  // Hand back the current value.
+  *out = calc_ptr(stk, stk->pos);
+  return GSTACK_OK;
+}
+
+gstack_status_t gstack_try_pop(gstack_t* stk) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (stk->pos == GSTACK_BASE) {
+    return GSTACK_EMPTY;
+  }
+
+  // Publish and return.
+  --stk->pos;
+  STKSTATS_POP(stk->stats, 1, stk->pos + 1);
+  return GSTACK_OK;
+}
+
+int gstack_push(gstack_t* stk, void const* val) {
+  return publish_status(gstack_try_push(stk, val));
+}
+
+void* gstack_peek(gstack_t* stk) {
+  void* val;
+  if (publish_status(gstack_try_peek(stk, &val))) return NULL;
+  return val;
+}
+
+int gstack_pop(gstack_t* stk) {
+  return publish_status(gstack_try_pop(stk));
+}
+
+int gstack_push_n(gstack_t* stk, void const* vals, size_t count) {
+  // Check error conditions.
+  sanity_check(stk);
+  int64_t target = stk->pos + 1;
+  if (!vals) {
+    // User didn't give us any values to push.
+    errno = EINVAL;
+    return -1;
+  } else if (count > (uint64_t) (INT64_MAX - target)
+      || (count > (uint64_t) (stk->max - target) && grow_stack(stk, target + count))) {
+    // Batch doesn't fit, push none of it.
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // The records are contiguous both in the caller's array
+  // and in our buffer, so the whole batch is one copy.
+  // Padded records need a copy each to step over the padding.
+  char* dst = (char*) calc_ptr(stk, target);
+  if (is_packed(stk)) {
+    memcpy(dst, vals, count * stk->record_size);
+  } else {
+    char const* src = (char const*) vals;
+    for (size_t i = 0; i < count; ++i, dst += stk->stride, src += stk->record_size) {
+      memcpy(dst, src, stk->record_size);
+    }
+  }
+
+  // Publish and return.
+  stk->pos += count;
+  STKSTATS_PUSH(stk->stats, count, stk->pos + 1);
   errno = 0;
   return 0;
 }
 
-void* gstack_peek(gstack_t* stk) {
+void* gstack_peek_n(gstack_t* stk, size_t count) {
   // Check error conditions.
   sanity_check(stk);
-  if (stk->pos < 0) {
+  if (!count) {
+    errno = EINVAL;
+    return NULL;
+  } else if (count > gstack_size(stk)) {
     errno = ENOENT;
     return NULL;
   }
 
-  // Return the current value.
+  // Return a view of the top count records.
+  // The view is ordered bottom to top, so the last
+  // record in it is the one gstack_peek would return.
   errno = 0;
-  return calc_ptr(stk, stk->pos);
+  return calc_ptr(stk, stk->pos - count + 1);
 }
 
-int gstack_pop(gstack_t* stk) {
+int gstack_pop_n(gstack_t* stk, size_t count) {
   // Check error conditions.
   sanity_check(stk);
-  if (stk->pos == GSTACK_BASE) {
+  if (count > gstack_size(stk)) {
     errno = ENOENT;
     return -1;
   }
 
   // Publish and return.
-  --stk->pos;
+  stk->pos -= count;
+  STKSTATS_POP(stk->stats, count, stk->pos + 1);
   errno = 0;
   return 0;
 }
@@ -120,3 +353,132 @@ size_t gstack_size(gstack_t const* stk) {
 size_t gstack_capacity(gstack_t const* stk) {
   return stk->max;
 }
+
+size_t gstack_stride(gstack_t const* stk) {
+  return stk->stride;
+}
+
+int gstack_stats(gstack_t const* stk, stkstats_t* out) {
+  // Check error conditions.
+  if (!stk || !out) {
+    errno = EINVAL;
+    return -1;
+  }
+#ifdef STACK_STATS
+  if (stk->stats) {
+    *out = *stk->stats;
+    out->prev = out->next = NULL;
+    errno = 0;
+    return 0;
+  }
+#endif
+  errno = ENOTSUP;
+  return -1;
+}
+
+static int write_all(int fd, struct iovec* iov, int count) {
+  // writev can stop short, so keep going until everything is out.
+  while (count) {
+    ssize_t written = writev(fd, iov, count);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    while (count && (size_t) written >= iov->iov_len) {
+      written -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count) {
+      iov->iov_base = (char*) iov->iov_base + written;
+      iov->iov_len -= written;
+    }
+  }
+  return 0;
+}
+
+int gstack_save(gstack_t* stk, int fd) {
+  // Check error conditions.
+  sanity_check(stk);
+
+  // The header and the records go out together.
+  gstack_snap_header_t header = {GSTACK_SNAP_MAGIC, GSTACK_SNAP_VERSION, 0,
+    stk->record_size, gstack_size(stk)};
+  struct iovec iov[GSTACK_SNAP_IOVECS] = {{&header, sizeof(header)}};
+  if (is_packed(stk)) {
+    iov[1].iov_base = records(stk);
+    iov[1].iov_len = gstack_size(stk) * stk->record_size;
+    if (write_all(fd, iov, 2)) return -1;
+    errno = 0;
+    return 0;
+  }
+
+  // Padded records go out one buffer each, to leave the
+  // padding out, a batch at a time.
+  int count = 1;
+  for (int64_t pos = 0; pos <= stk->pos; ++pos) {
+    iov[count].iov_base = calc_ptr(stk, pos);
+    iov[count].iov_len = stk->record_size;
+    if (++count == GSTACK_SNAP_IOVECS) {
+      if (write_all(fd, iov, count)) return -1;
+      count = 0;
+    }
+  }
+  if (count && write_all(fd, iov, count)) return -1;
+  errno = 0;
+  return 0;
+}
+
+static int read_all(int fd, void* buf, size_t len) {
+  // Hitting the end of the file early means the snapshot
+  // was cut short.
+  char* curr = (char*) buf;
+  while (len) {
+    ssize_t got = read(fd, curr, len);
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    } else if (!got) {
+      errno = EINVAL;
+      return -1;
+    }
+    curr += got;
+    len -= got;
+  }
+  return 0;
+}
+
+int gstack_load(gstack_t* stk, int fd) {
+  // Check error conditions.
+  sanity_check(stk);
+  gstack_snap_header_t header;
+  if (read_all(fd, &header, sizeof(header))) return -1;
+  if (header.magic != GSTACK_SNAP_MAGIC || header.version != GSTACK_SNAP_VERSION
+      || header.record_size != stk->record_size) {
+    errno = EINVAL;
+    return -1;
+  }
+  int64_t target = stk->pos + 1;
+  if (header.count > (uint64_t) (INT64_MAX - target)
+      || (header.count > (uint64_t) (stk->max - target) && grow_stack(stk, target + header.count))) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // Read straight into the buffer, and only publish once
+  // every record is in.
+  char* run = (char*) calc_ptr(stk, target);
+  if (read_all(fd, run, header.count * stk->record_size)) return -1;
+
+  // Padded records arrive packed at the front, so spread them
+  // out, last first so nothing is overwritten early.
+  if (!is_packed(stk)) {
+    for (int64_t i = header.count - 1; i > 0; --i) {
+      memmove(run + record_offset(stk, i), run + (size_t) i * stk->record_size, stk->record_size);
+    }
+  }
+  stk->pos += header.count;
+  STKSTATS_PUSH(stk->stats, header.count, stk->pos + 1);
+  errno = 0;
+  return 0;
+}
@@ -7,23 +7,75 @@
 #include <stddef.h>
 #include <inttypes.h>
 
+/*----- Project Includes -----*/
+
+#include "../stats/stkstats.h"
+
 /*----- Numerical Constants -----*/
 
-#define GSTACK_SIZE        (4096)
 #define GSTACK_BASE        (-1)
 
+// Bytes of records a stack holds inside of itself before moving
+// them out to the heap. The default fills out the rest of two
+// cache lines on 64-bit targets, which leaves less room when the
+// stats pointer is compiled in.
+// Override it at build time with -DGSTACK_INLINE_SIZE=n.
+#ifdef STACK_STATS
+#define GSTACK_DEFAULT_INLINE_SIZE (64)
+#else
+#define GSTACK_DEFAULT_INLINE_SIZE (80)
+#endif
+#ifndef GSTACK_INLINE_SIZE
+#define GSTACK_INLINE_SIZE (GSTACK_DEFAULT_INLINE_SIZE)
+#endif
+
+// The largest record alignment a stack can ask for, a page.
+#define GSTACK_MAX_ALIGN   (4096)
+
 /*----- Type Declarations -----*/
 
+// Result of the errno-free stack operations.
+typedef enum gstack_status {
+  GSTACK_OK,
+  GSTACK_EMPTY,         // Same as ENOENT
+  GSTACK_FULL,          // Same as ENOMEM, the stack couldn't grow
+  GSTACK_INVALID        // Same as EINVAL
+} gstack_status_t;
+
+// Records start out in the inline buffer, and move to a heap
+// buffer, doubling in size, once they outgrow it.
+// They never move back, so a stack that has grown stays grown
+// until it's destroyed.
+// The inline buffer is in a union so that it's aligned for any
+// basic type.
+// Records are stride bytes apart, which is record_size rounded up
+// to the requested alignment. When stride is a power of two,
+// stride_shift is its log, and is -1 otherwise.
+// Alignments past the inline buffer's own start on the heap.
+// align and stride_shift are kept narrow, GSTACK_MAX_ALIGN and the
+// bits in a size_t both fit, so the header stays small.
 typedef struct generic_stack {
   int64_t pos, max;
-  size_t record_size;
-  char buffer[GSTACK_SIZE];
+  size_t record_size, stride;
+  char* heap;
+  uint16_t align;
+  int8_t stride_shift;
+#ifdef STACK_STATS
+  stkstats_t* stats;    // Hot path counters, NULL if they couldn't be allocated
+#endif
+  union {
+    char buffer[GSTACK_INLINE_SIZE];
+    long double align_float;
+    int64_t align_int;
+    void* align_ptr;
+  } local;
 } gstack_t;
 
 /*----- Function Declarations -----*/
 
 // Lifecycle functions
 int gstack_init(gstack_t* stk, size_t record_size);
+int gstack_init_aligned(gstack_t* stk, size_t record_size, size_t align);
 void gstack_destroy(gstack_t* stk);
 
 // Stack operations
@@ -32,5 +84,41 @@ void* gstack_peek(gstack_t* stk);
 int gstack_pop(gstack_t* stk);
 size_t gstack_size(gstack_t const* stk);
 size_t gstack_capacity(gstack_t const* stk);
+size_t gstack_stride(gstack_t const* stk);
+
+// Errno-free stack operations
+// These report errors through their return value only,
+// and never read or write errno.
+gstack_status_t gstack_try_push(gstack_t* stk, void const* val);
+gstack_status_t gstack_try_peek(gstack_t* stk, void** out);
+gstack_status_t gstack_try_pop(gstack_t* stk);
+
+// Batch operations
+// These do a single capacity check and a single copy
+// for the whole batch of records.
+// Records in the batch handed to gstack_push_n are packed
+// record_size apart, but the view gstack_peek_n returns is
+// laid out like the stack, gstack_stride bytes apart.
+int gstack_push_n(gstack_t* stk, void const* vals, size_t count);
+void* gstack_peek_n(gstack_t* stk, size_t count);
+int gstack_pop_n(gstack_t* stk, size_t count);
+
+// Snapshots
+// gstack_save writes a versioned snapshot of every record to fd,
+// header and records together in a single writev.
+// gstack_load reads a snapshot from fd and pushes its records on
+// top of an initialized stack. It fails with EINVAL if the snapshot
+// is malformed or was taken from a stack with a different record
+// size, and with ENOMEM if the stack can't grow to fit it. Either
+// way it pushes nothing. Snapshots store records packed, so they
+// load into stacks of any alignment.
+int gstack_save(gstack_t* stk, int fd);
+int gstack_load(gstack_t* stk, int fd);
+
+// Statistics
+// gstack_stats copies out the stack's counters. It fails with
+// ENOTSUP unless the stack was built with STACK_STATS, and
+// managed to register its counters.
+int gstack_stats(gstack_t const* stk, stkstats_t* out);
 
 #endif
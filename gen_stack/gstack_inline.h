@@ -0,0 +1,59 @@
+#ifndef GSTACK_INLINE_H
+#define GSTACK_INLINE_H
+
+/*----- System Includes -----*/
+
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "gstack.h"
+
+/*----- Function Implementations -----*/
+
+// Opt-in inline versions of the hot stack operations.
+// Each one handles the common case, a stack with room to spare,
+// right here in the caller, and falls back to the out of line
+// operation in gstack.c for everything else, including growth.
+//
+// Like the typed stacks, the fast path leaves errno alone on
+// success, so only check errno after a failure.
+
+inline static void* gstack_at_inline(gstack_t* stk, int64_t pos) {
+  // Same as calc_ptr in gstack.c.
+  char* base = stk->heap ? stk->heap : stk->local.buffer;
+  size_t offset = stk->stride_shift >= 0 ?
+    (size_t) pos << stk->stride_shift : (size_t) pos * stk->stride;
+  return base + offset;
+}
+
+inline static int gstack_push_inline(gstack_t* stk, void const* val) {
+  int64_t target = stk->pos + 1;
+  if (target < stk->max && val) {
+    memcpy(gstack_at_inline(stk, target), val, stk->record_size);
+    stk->pos = target;
+    STKSTATS_PUSH(stk->stats, 1, target + 1);
+    return 0;
+  }
+  return gstack_push(stk, val);
+}
+
+inline static void* gstack_peek_inline(gstack_t* stk) {
+  if (stk->pos >= 0) return gstack_at_inline(stk, stk->pos);
+  return gstack_peek(stk);
+}
+
+inline static int gstack_pop_inline(gstack_t* stk) {
+  if (stk->pos >= 0) {
+    --stk->pos;
+    STKSTATS_POP(stk->stats, 1, stk->pos + 1);
+    return 0;
+  }
+  return gstack_pop(stk);
+}
+
+inline static size_t gstack_size_inline(gstack_t const* stk) {
+  return stk->pos + 1;
+}
+
+#endif
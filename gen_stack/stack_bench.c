@@ -0,0 +1,78 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "gstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_ROUNDS        (100000LL)
+#define DEPTH                 (512)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int64_t bench_errno(gstack_t* stk, int64_t rounds) {
+  // Push to a fixed depth, then peek and pop everything, through
+  // the original API that writes errno on every call.
+  int64_t sum = 0;
+  for (int64_t round = 0; round < rounds; ++round) {
+    for (int64_t val = 0; val < DEPTH; ++val) gstack_push(stk, &val);
+    while (gstack_size(stk)) {
+      sum += *(int64_t*) gstack_peek(stk);
+      gstack_pop(stk);
+    }
+  }
+  return sum;
+}
+
+static int64_t bench_status(gstack_t* stk, int64_t rounds) {
+  // Same workload through the errno-free API.
+  int64_t sum = 0;
+  for (int64_t round = 0; round < rounds; ++round) {
+    for (int64_t val = 0; val < DEPTH; ++val) gstack_try_push(stk, &val);
+    void* top;
+    while (gstack_try_peek(stk, &top) == GSTACK_OK) {
+      sum += *(int64_t*) top;
+      gstack_try_pop(stk);
+    }
+  }
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  // Usage: stack_bench [rounds]
+  int64_t rounds = DEFAULT_ROUNDS;
+  if (argc >= 2) rounds = strtoll(argv[1], NULL, 10);
+
+  // Each round is a push, a peek and a pop per record.
+  // The first round moves the stack out to the heap, and every
+  // round after that reuses the same buffer.
+  gstack_t stk;
+  gstack_init(&stk, sizeof(int64_t));
+  double ops = (double) rounds * DEPTH * 3;
+
+  double start = now();
+  int64_t sum = bench_errno(&stk, rounds);
+  double elapsed = now() - start;
+  printf("api=errno ns_per_op=%.2f checksum=%" PRId64 "\n", elapsed * 1e9 / ops, sum);
+
+  start = now();
+  sum = bench_status(&stk, rounds);
+  elapsed = now() - start;
+  printf("api=status ns_per_op=%.2f checksum=%" PRId64 "\n", elapsed * 1e9 / ops, sum);
+
+  gstack_destroy(&stk);
+  return 0;
+}
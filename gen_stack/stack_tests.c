@@ -1,18 +1,29 @@
 /*----- System Includes -----*/
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 
 /*----- Project Includes -----*/
 
+#include "../prng/prng.h"
 #include "gstack.h"
+#include "gstack_inline.h"
 
 /*----- Numerical Constants -----*/
 
+#define SEED              (42)
 #define STR_LEN           (8)
 #define MAX_STRING        (16)
 #define NUM_STRINGS       (16)
+#define SNAP_PATH         "stack_tests.snap"
+#define ALIGN             (64)
+#define NUM_RECORDS       (1000)
 
 /*----- Type Declarations -----*/
 
@@ -21,22 +32,19 @@ typedef struct string {
   char str[MAX_STRING];
 } string_t;
 
+/*----- Globals -----*/
+
+// Seeded the same way every run, so failures reproduce.
+static prng_t rng;
+
 /*----- Function Implementations -----*/
 
 char* rand_string() {
-  // Our character set to pull from
-  static char const* alpha = "abcdefghijklmnopqrstuvwxyz";
-
   // Get memory for our string.
   char* str = (char*) malloc(sizeof(char) * (STR_LEN + 1));
 
-  // Write in our random characters.
-  // XXX: The function rand is a TERRIBLE random number generator
-  // Don't write this code in production
-  char* curr = str;
-  while (curr - str < STR_LEN) {
-    *curr++ = alpha[rand() % 26];
-  }
+  // Write in our random characters, up to thirteen per draw.
+  prng_alpha(&rng, str, STR_LEN);
 
   // Terminate our string and return.
   str[STR_LEN] = '\0';
@@ -82,6 +90,8 @@ string_t** gen_strings() {
 }
 
 int main() {
+  prng_seed(&rng, SEED);
+
   // Initialize a stack.
   gstack_t stk;
   gstack_init(&stk, sizeof(string_t));
@@ -112,6 +122,175 @@ int main() {
   assert(!gstack_peek(&stk));
   assert(errno == ENOENT);
 
+  // Push all of our strings again, this time as a single batch.
+  string_t batch[NUM_STRINGS];
+  for (int i = 0; i < NUM_STRINGS; i++) batch[i] = *strs[i];
+  int err = gstack_push_n(&stk, batch, NUM_STRINGS);
+  assert(!err);
+  assert(gstack_size(&stk) == NUM_STRINGS);
+
+  // The batch view should match what we pushed, and
+  // should end with the record on top of the stack.
+  string_t* view = (string_t*) gstack_peek_n(&stk, NUM_STRINGS);
+  assert(!memcmp(view, batch, sizeof(batch)));
+  assert(&view[NUM_STRINGS - 1] == gstack_peek(&stk));
+  assert(!gstack_peek_n(&stk, NUM_STRINGS + 1));
+  assert(errno == ENOENT);
+
+  // Pop the batch off in two halves.
+  err = gstack_pop_n(&stk, NUM_STRINGS / 2);
+  assert(!err);
+  string_t* curr = (string_t*) gstack_peek(&stk);
+  assert(!strcmp(curr->str, strs[NUM_STRINGS / 2 - 1]->str));
+  err = gstack_pop_n(&stk, NUM_STRINGS / 2);
+  assert(!err && !gstack_size(&stk));
+  assert(gstack_pop_n(&stk, 1) && errno == ENOENT);
+
+  // A batch too large to ever fit should be rejected whole.
+  err = gstack_push_n(&stk, batch, SIZE_MAX);
+  assert(err && errno == ENOMEM);
+  assert(!gstack_size(&stk));
+
+  // The errno-free variants report the same conditions
+  // through their return values, and leave errno alone.
+  errno = 0;
+  void* top;
+  assert(gstack_try_pop(&stk) == GSTACK_EMPTY);
+  assert(gstack_try_peek(&stk, &top) == GSTACK_EMPTY);
+  assert(gstack_try_push(&stk, NULL) == GSTACK_INVALID);
+  for (int i = 0; i < NUM_STRINGS; i++) {
+    assert(gstack_try_push(&stk, strs[i]) == GSTACK_OK);
+  }
+  assert(gstack_try_peek(&stk, &top) == GSTACK_OK);
+  assert(!strcmp(((string_t*) top)->str, strs[NUM_STRINGS - 1]->str));
+  while (gstack_try_pop(&stk) == GSTACK_OK);
+  assert(!gstack_size(&stk));
+  assert(errno == 0);
+
+  // A snapshot should come back as the same records, pushed on top
+  // of whatever the stack already holds.
+  int fd = open(SNAP_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  assert(fd >= 0);
+  assert(!gstack_push_n(&stk, batch, NUM_STRINGS));
+  assert(!gstack_save(&stk, fd));
+  assert(!gstack_pop_n(&stk, NUM_STRINGS / 2));
+  lseek(fd, 0, SEEK_SET);
+  assert(!gstack_load(&stk, fd));
+  assert(gstack_size(&stk) == NUM_STRINGS / 2 + NUM_STRINGS);
+  view = (string_t*) gstack_peek_n(&stk, NUM_STRINGS);
+  assert(!memcmp(view, batch, sizeof(batch)));
+
+  // Loading into a stack of another record size should push nothing.
+  gstack_t small;
+  gstack_init(&small, sizeof(int64_t));
+  lseek(fd, 0, SEEK_SET);
+  assert(gstack_load(&small, fd) && errno == EINVAL);
+  assert(!gstack_size(&small));
+  gstack_destroy(&small);
+  close(fd);
+  remove(SNAP_PATH);
+
+  // With the default inline buffer, a stack is two cache lines.
+#if defined(__x86_64__) && GSTACK_INLINE_SIZE == GSTACK_DEFAULT_INLINE_SIZE
+  assert(sizeof(gstack_t) == 128);
+#endif
+
+  // Records start out inline, and move to the heap once they
+  // outgrow it, without losing anything.
+  gstack_t fresh;
+  gstack_init(&fresh, sizeof(string_t));
+  size_t inline_max = gstack_capacity(&fresh);
+  assert(inline_max == GSTACK_INLINE_SIZE / sizeof(string_t));
+  for (int i = 0; i < NUM_STRINGS * 8; i++) {
+    err = gstack_push(&fresh, strs[i % NUM_STRINGS]);
+    assert(!err);
+  }
+  assert(gstack_capacity(&fresh) > inline_max);
+  for (int i = NUM_STRINGS * 8 - 1; i >= 0; i--) {
+    curr = (string_t*) gstack_peek(&fresh);
+    assert(!strcmp(curr->str, strs[i % NUM_STRINGS]->str));
+    gstack_pop(&fresh);
+  }
+  gstack_destroy(&fresh);
+
+  // Records too large to fit inline at all are fine too.
+  gstack_t large;
+  char record[GSTACK_INLINE_SIZE * 2];
+  assert(!gstack_init(&large, sizeof(record)));
+  assert(!gstack_capacity(&large));
+  for (int i = 0; i < NUM_STRINGS; i++) {
+    memset(record, i, sizeof(record));
+    assert(!gstack_push(&large, record));
+  }
+  assert(((char*) gstack_peek(&large))[sizeof(record) - 1] == NUM_STRINGS - 1);
+  gstack_destroy(&large);
+  assert(gstack_init(&large, 0) && errno == EINVAL);
+
+  // Aligned stacks pad their records out, and keep them aligned
+  // inline and on the heap.
+  gstack_t aligned;
+  assert(!gstack_init_aligned(&aligned, sizeof(string_t), ALIGN));
+  assert(gstack_stride(&aligned) == ALIGN);
+  for (int i = 0; i < NUM_STRINGS * 8; i++) {
+    assert(!gstack_push(&aligned, strs[i % NUM_STRINGS]));
+    assert((uintptr_t) gstack_peek(&aligned) % ALIGN == 0);
+  }
+  assert(!gstack_push_n(&aligned, batch, NUM_STRINGS));
+  view = (string_t*) gstack_peek_n(&aligned, NUM_STRINGS);
+  for (int i = 0; i < NUM_STRINGS; i++) {
+    string_t* record = (string_t*) ((char*) view + i * gstack_stride(&aligned));
+    assert(!memcmp(record, &batch[i], sizeof(string_t)));
+  }
+
+  // Snapshots move between aligned and packed stacks.
+  fd = open(SNAP_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  assert(fd >= 0);
+  assert(!gstack_save(&aligned, fd));
+  gstack_t packed;
+  gstack_init(&packed, sizeof(string_t));
+  lseek(fd, 0, SEEK_SET);
+  assert(!gstack_load(&packed, fd));
+  assert(gstack_size(&packed) == gstack_size(&aligned));
+  assert(!ftruncate(fd, 0));
+  lseek(fd, 0, SEEK_SET);
+  assert(!gstack_save(&packed, fd));
+  gstack_t reloaded;
+  gstack_init_aligned(&reloaded, sizeof(string_t), ALIGN);
+  lseek(fd, 0, SEEK_SET);
+  assert(!gstack_load(&reloaded, fd));
+  close(fd);
+  while (gstack_size(&packed)) {
+    assert(!memcmp(gstack_peek(&packed), gstack_peek(&aligned), sizeof(string_t)));
+    assert(!memcmp(gstack_peek(&reloaded), gstack_peek(&aligned), sizeof(string_t)));
+    gstack_pop(&packed);
+    gstack_pop(&reloaded);
+    gstack_pop(&aligned);
+  }
+  gstack_destroy(&reloaded);
+  gstack_destroy(&packed);
+  gstack_destroy(&aligned);
+  remove(SNAP_PATH);
+  assert(gstack_init_aligned(&aligned, sizeof(string_t), 24) && errno == EINVAL);
+
+  // The inline fast paths agree with the out of line operations,
+  // inline and on the heap, and fall back to them to grow.
+  gstack_t fast;
+  gstack_init(&fast, sizeof(int64_t));
+  for (int64_t i = 0; i < NUM_RECORDS; ++i) {
+    assert(!gstack_push_inline(&fast, &i));
+    assert(*(int64_t*) gstack_peek_inline(&fast) == i);
+    assert(gstack_peek_inline(&fast) == gstack_peek(&fast));
+  }
+  assert(gstack_size_inline(&fast) == NUM_RECORDS);
+  assert(gstack_push_inline(&fast, NULL) && errno == EINVAL);
+  for (int64_t i = NUM_RECORDS - 1; i >= 0; --i) {
+    assert(*(int64_t*) gstack_peek_inline(&fast) == i);
+    assert(!gstack_pop_inline(&fast));
+  }
+  assert(gstack_pop_inline(&fast) && errno == ENOENT);
+  assert(!gstack_peek_inline(&fast));
+  gstack_destroy(&fast);
+
   // Cleanup and exit.
   gstack_destroy(&stk);
   return 0;
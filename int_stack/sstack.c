@@ -13,6 +13,26 @@ inline static void sanity_check(sstack_t const* stk) {
   assert(stk && stk->pos < SSTACK_SIZE && stk->pos >= SSTACK_BASE);
 }
 
+inline static int publish_status(sstack_status_t status) {
+  // Translate a status into the errno convention
+  // used by the rest of the API.
+  switch (status) {
+    case SSTACK_OK:
+      errno = 0;
+      return 0;
+    case SSTACK_EMPTY:
+      errno = ENOENT;
+      break;
+    case SSTACK_FULL:
+      errno = ENOMEM;
+      break;
+    default:
+      errno = EINVAL;
+      break;
+  }
+  return -1;
+}
+
 int sstack_init(sstack_t* stk) {
   if (stk) {
     // Set the position to negative one
@@ -33,18 +53,16 @@ void sstack_destroy(sstack_t* stk) {
   (void) stk;
 }
 
-int sstack_push(sstack_t* stk, int64_t const* val) {
+sstack_status_t sstack_try_push(sstack_t* stk, int64_t const* val) {
   // Check error conditions.
   sanity_check(stk);
   int64_t target = stk->pos + 1;
   if (target == SSTACK_SIZE) {
     // Stack is full.
-    errno = ENOMEM;
-    return -1;
+    return SSTACK_FULL;
   } else if (!val) {
     // User didn't give us a value to push.
-    errno = EINVAL;
-    return -1;
+    return SSTACK_INVALID;
   }
 
   // Write the value into the stack.
@@ -52,35 +70,47 @@ int sstack_push(sstack_t* stk, int64_t const* val) {
 
   // Publish and return.
   ++stk->pos;
-  errno = 0;
-  return 0;
+  return SSTACK_OK;
 }
 
-int64_t* sstack_peek(sstack_t* stk) {
+sstack_status_t sstack_try_peek(sstack_t* stk, int64_t** out) {
   // Check error conditions.
   sanity_check(stk);
-  if (stk->pos < 0) {
-    errno = ENOENT;
-    return NULL;
+  if (!out) {
+    return SSTACK_INVALID;
+  } else if (stk->pos < 0) {
+    return SSTACK_EMPTY;
   }
 
-  // Return the current value.
-  errno = 0;
-  return &stk->stk[stk->pos];
+  // Hand back the current value.
+  *out = &stk->stk[stk->pos];
+  return SSTACK_OK;
 }
 
-int sstack_pop(sstack_t* stk) {
+sstack_status_t sstack_try_pop(sstack_t* stk) {
   // Check error conditions.
   sanity_check(stk);
   if (stk->pos == SSTACK_BASE) {
-    errno = ENOENT;
-    return -1;
+    return SSTACK_EMPTY;
   }
 
   // Publish and return.
   --stk->pos;
-  errno = 0;
-  return 0;
+  return SSTACK_OK;
+}
+
+int sstack_push(sstack_t* stk, int64_t const* val) {
+  return publish_status(sstack_try_push(stk, val));
+}
+
+int64_t* sstack_peek(sstack_t* stk) {
+  int64_t* val;
+  if (publish_status(sstack_try_peek(stk, &val))) return NULL;
+  return val;
+}
+
+int sstack_pop(sstack_t* stk) {
+  return publish_status(sstack_try_pop(stk));
 }
 
 size_t sstack_size(sstack_t const* stk) {
@@ -14,6 +14,14 @@
 
 /*----- Type Declarations -----*/
 
+// Result of the errno-free stack operations.
+typedef enum sstack_status {
+  SSTACK_OK,
+  SSTACK_EMPTY,         // Same as ENOENT
+  SSTACK_FULL,          // Same as ENOMEM
+  SSTACK_INVALID        // Same as EINVAL
+} sstack_status_t;
+
 typedef struct simple_stack {
   int64_t pos;
   int64_t stk[SSTACK_SIZE];
@@ -32,4 +40,11 @@ int sstack_pop(sstack_t* stk);
 size_t sstack_size(sstack_t const* stk);
 size_t sstack_capacity(sstack_t const* stk);
 
+// Errno-free stack operations
+// These report errors through their return value only,
+// and never read or write errno.
+sstack_status_t sstack_try_push(sstack_t* stk, int64_t const* val);
+sstack_status_t sstack_try_peek(sstack_t* stk, int64_t** out);
+sstack_status_t sstack_try_pop(sstack_t* stk);
+
 #endif
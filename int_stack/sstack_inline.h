@@ -0,0 +1,45 @@
+#ifndef SSTACK_INLINE_H
+#define SSTACK_INLINE_H
+
+/*----- Project Includes -----*/
+
+#include "sstack.h"
+
+/*----- Function Implementations -----*/
+
+// Opt-in inline versions of the hot stack operations.
+// Each one handles the common case right here in the caller, and
+// falls back to the out of line operation in sstack.c to report
+// a full or empty stack.
+//
+// Like the typed stacks, the fast path leaves errno alone on
+// success, so only check errno after a failure.
+
+inline static int sstack_push_inline(sstack_t* stk, int64_t const* val) {
+  int64_t target = stk->pos + 1;
+  if (target < SSTACK_SIZE && val) {
+    stk->stk[target] = *val;
+    stk->pos = target;
+    return 0;
+  }
+  return sstack_push(stk, val);
+}
+
+inline static int64_t* sstack_peek_inline(sstack_t* stk) {
+  if (stk->pos >= 0) return &stk->stk[stk->pos];
+  return sstack_peek(stk);
+}
+
+inline static int sstack_pop_inline(sstack_t* stk) {
+  if (stk->pos >= 0) {
+    --stk->pos;
+    return 0;
+  }
+  return sstack_pop(stk);
+}
+
+inline static size_t sstack_size_inline(sstack_t const* stk) {
+  return stk->pos + 1;
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "sstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_ROUNDS        (10000000LL)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int64_t bench_errno(sstack_t* stk, int64_t rounds) {
+  // Fill the stack, then peek and pop everything, through
+  // the original API that writes errno on every call.
+  int64_t sum = 0;
+  for (int64_t round = 0; round < rounds; ++round) {
+    for (int64_t val = 0; !sstack_push(stk, &val); ++val);
+    while (sstack_size(stk)) {
+      sum += *sstack_peek(stk);
+      sstack_pop(stk);
+    }
+  }
+  return sum;
+}
+
+static int64_t bench_status(sstack_t* stk, int64_t rounds) {
+  // Same workload through the errno-free API.
+  int64_t sum = 0;
+  for (int64_t round = 0; round < rounds; ++round) {
+    for (int64_t val = 0; sstack_try_push(stk, &val) == SSTACK_OK; ++val);
+    int64_t* top;
+    while (sstack_try_peek(stk, &top) == SSTACK_OK) {
+      sum += *top;
+      sstack_try_pop(stk);
+    }
+  }
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  // Usage: stack_bench [rounds]
+  int64_t rounds = DEFAULT_ROUNDS;
+  if (argc >= 2) rounds = strtoll(argv[1], NULL, 10);
+
+  // Each round is a push, a peek and a pop per slot,
+  // plus the push that finds the stack full.
+  sstack_t stk;
+  sstack_init(&stk);
+  double ops = (double) rounds * (SSTACK_SIZE * 3 + 1);
+
+  double start = now();
+  int64_t sum = bench_errno(&stk, rounds);
+  double elapsed = now() - start;
+  printf("api=errno ns_per_op=%.2f checksum=%" PRId64 "\n", elapsed * 1e9 / ops, sum);
+
+  start = now();
+  sum = bench_status(&stk, rounds);
+  elapsed = now() - start;
+  printf("api=status ns_per_op=%.2f checksum=%" PRId64 "\n", elapsed * 1e9 / ops, sum);
+
+  sstack_destroy(&stk);
+  return 0;
+}
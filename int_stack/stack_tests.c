@@ -5,6 +5,7 @@
 /*----- Project Includes -----*/
 
 #include "sstack.h"
+#include "sstack_inline.h"
 
 /*----- Function Implementations -----*/
 
@@ -38,6 +39,31 @@ int main() {
   assert(!sstack_peek(&stk));
   assert(errno == ENOENT);
 
+  // The errno-free variants report the same conditions
+  // through their return values, and leave errno alone.
+  errno = 0;
+  int64_t* top;
+  assert(sstack_try_pop(&stk) == SSTACK_EMPTY);
+  assert(sstack_try_peek(&stk, &top) == SSTACK_EMPTY);
+  assert(sstack_try_push(&stk, NULL) == SSTACK_INVALID);
+  while (sstack_try_push(&stk, &val) == SSTACK_OK) ++val;
+  assert(val == SSTACK_SIZE);
+  assert(sstack_try_push(&stk, &val) == SSTACK_FULL);
+  assert(sstack_try_peek(&stk, &top) == SSTACK_OK && *top + 1 == val);
+  while (sstack_try_pop(&stk) == SSTACK_OK) --val;
+  assert(val == 0);
+  assert(errno == 0);
+
+  // The inline fast paths agree with the out of line operations,
+  // and fall back to them to report a full or empty stack.
+  while (!sstack_push_inline(&stk, &val)) ++val;
+  assert(val == SSTACK_SIZE && errno == ENOMEM);
+  assert(sstack_size_inline(&stk) == sstack_size(&stk));
+  assert(sstack_peek_inline(&stk) == sstack_peek(&stk));
+  while (!sstack_pop_inline(&stk)) --val;
+  assert(val == 0 && errno == ENOENT);
+  assert(!sstack_peek_inline(&stk));
+
   // Cleanup and exit.
   sstack_destroy(&stk);
   return 0;
@@ -0,0 +1,196 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "lfstack.h"
+
+/*----- Numerical Constants -----*/
+
+// Heads store index + 1, so that zero can mean empty.
+#define LFSTACK_EMPTY                 (0)
+#define LFSTACK_MAX_BACKOFF           (1024)
+
+/*----- Function Implementations -----*/
+
+inline static void sanity_check(lfstack_t const* stk) {
+  // Make sure our basic invariants hold.
+  assert(stk && stk->next && stk->buffer && stk->capacity);
+}
+
+inline static uint32_t head_node(uint64_t head) {
+  return (uint32_t) head;
+}
+
+inline static uint64_t make_head(uint64_t prev, uint32_t node) {
+  // Bump the tag in the upper half every time the head changes.
+  return ((prev >> 32) + 1) << 32 | node;
+}
+
+inline static void* calc_ptr(lfstack_t* stk, uint32_t node) {
+  return stk->buffer + ((size_t) (node - 1) * stk->record_size);
+}
+
+inline static void backoff(unsigned* spins) {
+  // Under contention, a failed compare-and-swap means someone else
+  // made progress. Backing off for a growing number of spins gives
+  // them room to finish instead of fighting over the cache line.
+  for (volatile unsigned i = 0; i < *spins; ++i);
+  if (*spins < LFSTACK_MAX_BACKOFF) *spins *= 2;
+}
+
+static void push_node(lfstack_t* stk, _Atomic uint64_t* list, uint32_t node) {
+  unsigned spins = 1;
+  uint64_t head = atomic_load_explicit(list, memory_order_relaxed);
+  while (1) {
+    // Link ourselves in front of the current head, then try to
+    // swing the head to us. Release ordering publishes both the
+    // link and the record written before we were called.
+    atomic_store_explicit(&stk->next[node - 1], head_node(head), memory_order_relaxed);
+    uint64_t next = make_head(head, node);
+    if (atomic_compare_exchange_weak_explicit(list, &head, next,
+          memory_order_release, memory_order_relaxed)) {
+      return;
+    }
+    backoff(&spins);
+  }
+}
+
+static uint32_t pop_node(lfstack_t* stk, _Atomic uint64_t* list) {
+  unsigned spins = 1;
+  uint64_t head = atomic_load_explicit(list, memory_order_acquire);
+  while (head_node(head) != LFSTACK_EMPTY) {
+    // Reading the link of a node someone else just popped is fine,
+    // the tag will have moved on and our exchange will fail.
+    uint32_t node = head_node(head);
+    uint32_t next = atomic_load_explicit(&stk->next[node - 1], memory_order_relaxed);
+    if (atomic_compare_exchange_weak_explicit(list, &head, make_head(head, next),
+          memory_order_acquire, memory_order_acquire)) {
+      return node;
+    }
+    backoff(&spins);
+  }
+  return LFSTACK_EMPTY;
+}
+
+int lfstack_init(lfstack_t* stk, size_t record_size, size_t capacity) {
+  // Node indices have to fit in the lower half of a head.
+  if (!stk || !record_size || !capacity || capacity >= UINT32_MAX) {
+    errno = EINVAL;
+    return -1;
+  } else if (record_size > SIZE_MAX / capacity) {
+    // The buffer's size would wrap around.
+    errno = ENOMEM;
+    return -1;
+  }
+
+  stk->record_size = record_size;
+  stk->capacity = (uint32_t) capacity;
+  stk->next = malloc(sizeof(*stk->next) * capacity);
+  stk->buffer = malloc(record_size * capacity);
+  if (!stk->next || !stk->buffer) {
+    // Don't leak whichever allocation worked.
+    free(stk->next);
+    free(stk->buffer);
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // Every node starts out on the free list.
+  atomic_init(&stk->top, LFSTACK_EMPTY);
+  atomic_init(&stk->free, LFSTACK_EMPTY);
+  atomic_init(&stk->size, 0);
+  for (uint32_t i = 0; i < capacity; ++i) {
+    atomic_init(&stk->next[i], i + 2 > capacity ? LFSTACK_EMPTY : i + 2);
+  }
+  atomic_store(&stk->free, make_head(0, 1));
+  return 0;
+}
+
+void lfstack_destroy(lfstack_t* stk) {
+  free(stk->next);
+  free(stk->buffer);
+}
+
+int lfstack_push(lfstack_t* stk, void const* val) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (!val) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Grab a free node.
+  uint32_t node = pop_node(stk, &stk->free);
+  if (node == LFSTACK_EMPTY) {
+    // Stack is full.
+    errno = ENOMEM;
+    return -1;
+  }
+
+  // The node is ours alone until we publish it, so we
+  // can copy the record in without any synchronization.
+  memcpy(calc_ptr(stk, node), val, stk->record_size);
+  push_node(stk, &stk->top, node);
+  atomic_fetch_add_explicit(&stk->size, 1, memory_order_relaxed);
+  return 0;
+}
+
+int lfstack_peek(lfstack_t* stk, void* out) {
+  // Check error conditions.
+  sanity_check(stk);
+  if (!out) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Copy the top record, then make sure the head didn't change
+  // while we were copying. The tag changes on every push and pop,
+  // so an identical head means the record was never popped, and
+  // so was never overwritten, while we read it.
+  uint64_t head = atomic_load_explicit(&stk->top, memory_order_acquire);
+  while (head_node(head) != LFSTACK_EMPTY) {
+    memcpy(out, calc_ptr(stk, head_node(head)), stk->record_size);
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t check = atomic_load_explicit(&stk->top, memory_order_acquire);
+    if (check == head) return 0;
+    head = check;
+  }
+  errno = ENOENT;
+  return -1;
+}
+
+int lfstack_pop(lfstack_t* stk, void* out) {
+  // Check error conditions.
+  sanity_check(stk);
+  uint32_t node = pop_node(stk, &stk->top);
+  if (node == LFSTACK_EMPTY) {
+    errno = ENOENT;
+    return -1;
+  }
+
+  // The node is ours now, copy the record out before
+  // handing the node back to the free list.
+  if (out) memcpy(out, calc_ptr(stk, node), stk->record_size);
+  atomic_fetch_sub_explicit(&stk->size, 1, memory_order_relaxed);
+  push_node(stk, &stk->free, node);
+  return 0;
+}
+
+size_t lfstack_size(lfstack_t const* stk) {
+  // Check error conditions.
+  sanity_check(stk);
+
+  // Under concurrent use this is only a snapshot, and can
+  // briefly lag behind pushes and pops that are in flight.
+  int_fast64_t size = atomic_load_explicit(&stk->size, memory_order_relaxed);
+  return size > 0 ? (size_t) size : 0;
+}
+
+size_t lfstack_capacity(lfstack_t const* stk) {
+  return stk->capacity;
+}
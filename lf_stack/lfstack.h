@@ -0,0 +1,51 @@
+#ifndef LFSTACK_H
+#define LFSTACK_H
+
+/*----- System Includes -----*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <inttypes.h>
+
+/*----- Type Declarations -----*/
+
+// A lock-free, multi-producer/multi-consumer stack.
+// Records live in a fixed pool of nodes allocated at init time.
+// Nodes are linked by index rather than by pointer, and both the
+// stack and the free list are Treiber stacks whose heads pack a
+// 32-bit node index together with a 32-bit tag. Every successful
+// update bumps the tag, so a head that was popped and pushed back
+// in between our load and our compare-and-swap won't match,
+// which protects us from the ABA problem without hazard pointers.
+//
+// Since another thread can pop the top record at any moment,
+// peek and pop copy the record out instead of returning a pointer.
+// Errors are reported the same way as the other stacks, but errno
+// is only written on failure.
+typedef struct lockfree_stack {
+  _Atomic uint64_t top, free;
+  atomic_int_fast64_t size;
+  _Atomic uint32_t* next;
+  char* buffer;
+  size_t record_size;
+  uint32_t capacity;
+} lfstack_t;
+
+/*----- Function Declarations -----*/
+
+// Lifecycle functions
+// Neither is safe to call while other threads use the stack.
+int lfstack_init(lfstack_t* stk, size_t record_size, size_t capacity);
+void lfstack_destroy(lfstack_t* stk);
+
+// Stack operations
+// All of these are safe to call from any number of threads.
+// out may be NULL for lfstack_pop, to discard the record.
+int lfstack_push(lfstack_t* stk, void const* val);
+int lfstack_peek(lfstack_t* stk, void* out);
+int lfstack_pop(lfstack_t* stk, void* out);
+size_t lfstack_size(lfstack_t const* stk);
+size_t lfstack_capacity(lfstack_t const* stk);
+
+#endif
@@ -0,0 +1,88 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*----- Project Includes -----*/
+
+#include "lfstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_OPS           (2000000)
+#define CAPACITY              (1 << 16)
+
+/*----- Type Declarations -----*/
+
+typedef struct worker {
+  lfstack_t* stk;
+  int64_t ops;
+  pthread_barrier_t* start;
+} worker_t;
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* churn(void* arg) {
+  // Alternate pushes and pops, the usual shape of a shared work pool.
+  worker_t* work = (worker_t*) arg;
+  pthread_barrier_wait(work->start);
+  for (int64_t i = 0; i < work->ops; ++i) {
+    lfstack_push(work->stk, &i);
+    lfstack_pop(work->stk, NULL);
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv) {
+  // Usage: stack_bench [max threads] [ops per thread]
+  long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  int64_t ops = DEFAULT_OPS;
+  if (argc >= 2) max_threads = strtol(argv[1], NULL, 10);
+  if (argc >= 3) ops = strtoll(argv[2], NULL, 10);
+  if (max_threads < 1) max_threads = 1;
+
+  pthread_t* threads = malloc(sizeof(pthread_t) * max_threads);
+  worker_t* work = malloc(sizeof(worker_t) * max_threads);
+  // Double the thread count each round, finishing on max_threads.
+  for (long count = 1;; count = count * 2 < max_threads ? count * 2 : max_threads) {
+    lfstack_t stk;
+    if (lfstack_init(&stk, sizeof(int64_t), CAPACITY)) {
+      perror("lfstack_init");
+      return 1;
+    }
+
+    // Hold everyone at a barrier so that they all start together.
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, count + 1);
+    for (long i = 0; i < count; ++i) {
+      work[i] = (worker_t) {&stk, ops, &start};
+      pthread_create(&threads[i], NULL, churn, &work[i]);
+    }
+    pthread_barrier_wait(&start);
+    double begin = now();
+    for (long i = 0; i < count; ++i) pthread_join(threads[i], NULL);
+    double elapsed = now() - begin;
+
+    // Each iteration is a push and a pop.
+    double total = 2.0 * ops * count;
+    printf("threads=%ld ops=%.0f seconds=%.3f mops_per_sec=%.2f\n",
+        count, total, elapsed, total / elapsed / 1e6);
+    pthread_barrier_destroy(&start);
+    lfstack_destroy(&stk);
+    if (count == max_threads) break;
+  }
+  free(work);
+  free(threads);
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "lfstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define CAPACITY          (16)
+#define NUM_THREADS       (4)
+#define PER_THREAD        (100000)
+
+/*----- Type Declarations -----*/
+
+typedef struct worker {
+  lfstack_t* stk;
+  int64_t base;
+  char* seen;
+} worker_t;
+
+/*----- Function Implementations -----*/
+
+void* churn(void* arg) {
+  // Push our own range of values, popping whatever we find in
+  // between, and mark everything we pop as seen.
+  worker_t* work = (worker_t*) arg;
+  for (int64_t i = 0; i < PER_THREAD; ++i) {
+    int64_t val = work->base + i;
+    while (lfstack_push(work->stk, &val)) assert(errno == ENOMEM);
+
+    int64_t out;
+    if (!lfstack_pop(work->stk, &out)) {
+      assert(!work->seen[out]);
+      work->seen[out] = 1;
+    }
+  }
+  return NULL;
+}
+
+int main() {
+  // Initialize a stack.
+  lfstack_t stk;
+  int err = lfstack_init(&stk, sizeof(int64_t), CAPACITY);
+  assert(!err);
+
+  // Records too large for the whole buffer to be addressable fail,
+  // rather than getting a buffer that wrapped around.
+  lfstack_t huge;
+  assert(lfstack_init(&huge, SIZE_MAX / 2 + 1, 2) && errno == ENOMEM);
+
+  // Push until the stack fills.
+  int64_t val = 0;
+  do {
+    err = lfstack_push(&stk, &val);
+  } while (!err && ++val);
+  assert(errno == ENOMEM);
+  assert(val == CAPACITY);
+  assert(lfstack_size(&stk) == CAPACITY);
+
+  // Pop things off the stack and ensure things
+  // come out in the right order.
+  while (lfstack_size(&stk)) {
+    int64_t curr;
+    err = lfstack_peek(&stk, &curr);
+    assert(!err && curr + 1 == val);
+    err = lfstack_pop(&stk, &curr);
+    assert(!err && curr + 1 == val);
+    --val;
+  }
+  assert(val == 0);
+  assert(lfstack_peek(&stk, &val) && errno == ENOENT);
+  assert(lfstack_pop(&stk, NULL) && errno == ENOENT);
+
+  // Hammer the stack from several threads at once.
+  // Every value pushed should be popped exactly once.
+  char* seen = calloc(NUM_THREADS * PER_THREAD, 1);
+  pthread_t threads[NUM_THREADS];
+  worker_t work[NUM_THREADS];
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    work[i] = (worker_t) {&stk, (int64_t) i * PER_THREAD, seen};
+    pthread_create(&threads[i], NULL, churn, &work[i]);
+  }
+  for (int i = 0; i < NUM_THREADS; ++i) pthread_join(threads[i], NULL);
+
+  // Drain whatever's left over, and make sure nothing went missing.
+  int64_t out;
+  while (!lfstack_pop(&stk, &out)) {
+    assert(!seen[out]);
+    seen[out] = 1;
+  }
+  for (int64_t i = 0; i < NUM_THREADS * PER_THREAD; ++i) assert(seen[i]);
+  assert(!lfstack_size(&stk));
+
+  // Cleanup and exit.
+  free(seen);
+  lfstack_destroy(&stk);
+  return 0;
+}
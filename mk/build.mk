@@ -0,0 +1,89 @@
+# Build settings shared by the module Makefiles.
+# Set any module variables first, then include this.
+#
+#   make                    debug build, asserts and symbols on
+#   make MODE=release       -O3 -DNDEBUG -flto -march=$(ARCH)
+#   make MODE=profile       optimized, but with symbols and frame
+#                           pointers, for perf and friends
+#   make pgo                release libraries, trained on PGO_RUN
+#   make lib                static and shared libraries
+#   make STATS=1            stacks count pushes, pops and growth,
+#                           in any mode
+#
+# Modules that build a library set LIB to its name, and LIB_OBJS
+# to the objects in it. OBJS lists every object the module builds,
+# so they can all be rebuilt when the mode changes.
+
+CC = gcc
+STD = c99
+AR = gcc-ar
+MODE ?= debug
+ARCH ?= native
+STATS ?= 0
+PGO_DIR = $(CURDIR)/pgo-data
+PGO_TARGET ?= lib
+
+ifeq ($(MODE),debug)
+  MODE_FLAGS = -O0 -g
+else ifeq ($(MODE),release)
+  MODE_FLAGS = -O3 -DNDEBUG -flto -march=$(ARCH)
+else ifeq ($(MODE),profile)
+  MODE_FLAGS = -O2 -g -fno-omit-frame-pointer -march=$(ARCH)
+else ifeq ($(MODE),pgo-gen)
+  MODE_FLAGS = -O3 -DNDEBUG -march=$(ARCH) -fprofile-generate=$(PGO_DIR)
+else ifeq ($(MODE),pgo-use)
+  MODE_FLAGS = -O3 -DNDEBUG -flto -march=$(ARCH) -fprofile-use=$(PGO_DIR) \
+    -fprofile-partial-training -Wno-missing-profile
+else
+  $(error Unknown MODE '$(MODE)', expected debug, release or profile)
+endif
+
+# Objects are always position independent, so the same ones go
+# into both the static and the shared library.
+# Link with the same flags, which LTO needs to see again.
+CFLAGS = -std=$(STD) -fPIC $(MODE_FLAGS)
+
+# Statistics change the layout of the stacks, so everything in
+# a program has to be built with the same setting.
+ifeq ($(STATS),1)
+  CFLAGS += -DSTACK_STATS -pthread
+endif
+
+# Tests are only as good as their asserts, so they keep them
+# in every mode.
+TEST_FLAGS = -UNDEBUG
+
+# Remember what the objects were last built with, and rebuild
+# them all when that changes, rather than mixing modes.
+MODE_STAMP = .build-mode
+$(shell echo '$(MODE) $(ARCH) $(STATS)' | cmp -s - $(MODE_STAMP) || echo '$(MODE) $(ARCH) $(STATS)' > $(MODE_STAMP))
+$(OBJS): $(MODE_STAMP)
+
+.DEFAULT_GOAL := all
+
+ifdef LIB
+LIBS = lib$(LIB).a lib$(LIB).so
+
+lib$(LIB).a: $(LIB_OBJS)
+	rm -f $@
+	$(AR) rcs $@ $^
+
+lib$(LIB).so: $(LIB_OBJS)
+	$(CC) $(CFLAGS) -shared $^ -o $@
+
+lib: $(LIBS)
+endif
+
+# Build PGO_TRAIN instrumented, run PGO_RUN to collect a profile,
+# then rebuild PGO_TARGET with it. The mode change rebuilds every
+# object in between.
+pgo:
+	rm -rf $(PGO_DIR)
+	$(MAKE) MODE=pgo-gen $(PGO_TRAIN)
+	$(PGO_RUN)
+	$(MAKE) MODE=pgo-use $(PGO_TARGET)
+
+clean-build:
+	rm -rf $(MODE_STAMP) $(PGO_DIR) $(LIBS)
+
+.PHONY: lib pgo clean-build
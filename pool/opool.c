@@ -0,0 +1,206 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "opool.h"
+#include "../dyn_stack/dstack_inline.h"
+
+/*----- Function Implementations -----*/
+
+inline static void sanity_check(opool_t const* pool) {
+  // Make sure our basic invariants hold.
+  // Only the fields that never change after init, since other
+  // threads may be using the pool.
+  assert(pool && pool->slot_size >= pool->object_size && pool->slab_slots);
+}
+
+static int add_slab(opool_t* pool) {
+  // Check that the pool can still be counted, and the slab sized.
+  if (pool->capacity > INT64_MAX - (int64_t) pool->slab_slots) return -1;
+  void* slab;
+  if (posix_memalign(&slab, OPOOL_SLAB_ALIGN, pool->slot_size * pool->slab_slots)) return -1;
+
+  // Make room for the slab, and for every slot we'll ever own on
+  // the free stack, before anything is published.
+  int64_t capacity = pool->capacity + pool->slab_slots;
+  if (dstack_reserve(&pool->free, capacity) || dstack_push(&pool->slabs, &slab)) {
+    free(slab);
+    return -1;
+  }
+
+  // Push the slots top down, so they're handed out in
+  // address order.
+  for (size_t i = pool->slab_slots; i-- > 0;) {
+    void* slot = (char*) slab + i * pool->slot_size;
+    dstack_push_inline(&pool->free, &slot);
+  }
+  pool->capacity = capacity;
+  return 0;
+}
+
+static size_t take_slots(opool_t* pool, void** out, size_t count) {
+  // Hand out up to count slots from the free stack, carving
+  // a new slab if it's empty. Call with the lock held.
+  if (!dstack_size_inline(&pool->free) && add_slab(pool)) return 0;
+  size_t avail = dstack_size_inline(&pool->free);
+  if (count > avail) count = avail;
+  memcpy(out, dstack_peek_n(&pool->free, count), sizeof(void*) * count);
+  dstack_pop_n(&pool->free, count);
+  return count;
+}
+
+int opool_init(opool_t* pool, size_t object_size, size_t slab_slots) {
+  // Check error conditions.
+  if (!pool || !object_size || object_size > SIZE_MAX - OPOOL_ALIGN) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Every slot has to be able to hold a pointer, and keep the
+  // slot after it aligned.
+  size_t slot_size = (object_size + OPOOL_ALIGN - 1) & ~(OPOOL_ALIGN - 1);
+  if (!slab_slots) slab_slots = slot_size < OPOOL_SLAB_BYTES ? OPOOL_SLAB_BYTES / slot_size : 1;
+  if (slab_slots > SIZE_MAX / slot_size || slab_slots > INT64_MAX) {
+    errno = EINVAL;
+    return -1;
+  }
+  pool->object_size = object_size;
+  pool->slot_size = slot_size;
+  pool->slab_slots = slab_slots;
+  pool->capacity = 0;
+
+  // Set up the stacks and the lock, undoing whatever
+  // we'd done if one of them fails.
+  if (dstack_init(&pool->free, sizeof(void*), NULL)) return -1;
+  if (dstack_init(&pool->slabs, sizeof(void*), NULL)) {
+    dstack_destroy(&pool->free);
+    return -1;
+  }
+  int err = pthread_mutex_init(&pool->lock, NULL);
+  if (err) {
+    dstack_destroy(&pool->slabs);
+    dstack_destroy(&pool->free);
+    errno = err;
+    return -1;
+  }
+  errno = 0;
+  return 0;
+}
+
+void opool_destroy(opool_t* pool) {
+  sanity_check(pool);
+  while (dstack_size(&pool->slabs)) {
+    free(*(void**) dstack_peek(&pool->slabs));
+    dstack_pop(&pool->slabs);
+  }
+  dstack_destroy(&pool->slabs);
+  dstack_destroy(&pool->free);
+  pthread_mutex_destroy(&pool->lock);
+}
+
+void* opool_alloc(opool_t* pool) {
+  sanity_check(pool);
+  void* obj;
+  pthread_mutex_lock(&pool->lock);
+  size_t got = take_slots(pool, &obj, 1);
+  pthread_mutex_unlock(&pool->lock);
+  if (!got) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  return obj;
+}
+
+void opool_free(opool_t* pool, void* obj) {
+  sanity_check(pool);
+  if (!obj) return;
+
+  // There's always room, add_slab made sure of that.
+  pthread_mutex_lock(&pool->lock);
+  dstack_push_inline(&pool->free, &obj);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+size_t opool_capacity(opool_t* pool) {
+  sanity_check(pool);
+  pthread_mutex_lock(&pool->lock);
+  size_t capacity = pool->capacity;
+  pthread_mutex_unlock(&pool->lock);
+  return capacity;
+}
+
+size_t opool_available(opool_t* pool) {
+  sanity_check(pool);
+  pthread_mutex_lock(&pool->lock);
+  size_t avail = dstack_size_inline(&pool->free);
+  pthread_mutex_unlock(&pool->lock);
+  return avail;
+}
+
+int opool_cache_init(opool_cache_t* cache, opool_t* pool) {
+  // Check error conditions.
+  if (!cache || !pool) {
+    errno = EINVAL;
+    return -1;
+  }
+  cache->pool = pool;
+  cache->count = 0;
+  errno = 0;
+  return 0;
+}
+
+static void flush_cache(opool_cache_t* cache, int64_t keep) {
+  // Give back everything past the bottom keep slots, in a single
+  // batch, under a single lock.
+  // The pool has room for every slot it owns, so this can't fail.
+  int64_t count = cache->count - keep;
+  if (count <= 0) return;
+  opool_t* pool = cache->pool;
+  pthread_mutex_lock(&pool->lock);
+  dstack_push_n(&pool->free, cache->slots + keep, count);
+  pthread_mutex_unlock(&pool->lock);
+  cache->count = keep;
+}
+
+void opool_cache_destroy(opool_cache_t* cache) {
+  flush_cache(cache, 0);
+}
+
+void* opool_cache_alloc(opool_cache_t* cache) {
+  // Refill from the pool when we run dry, a batch at a time.
+  if (!cache->count) {
+    opool_t* pool = cache->pool;
+    pthread_mutex_lock(&pool->lock);
+    cache->count = take_slots(pool, cache->slots, OPOOL_CACHE_BATCH);
+    pthread_mutex_unlock(&pool->lock);
+    if (!cache->count) {
+      errno = ENOMEM;
+      return NULL;
+    }
+  }
+  return cache->slots[--cache->count];
+}
+
+void opool_cache_free(opool_cache_t* cache, void* obj) {
+  if (!obj) return;
+
+  // Spill half back to the pool when we're full, keeping the
+  // most recently freed half, which is still warm.
+  if (cache->count == OPOOL_CACHE_SLOTS) {
+    int64_t spill = OPOOL_CACHE_SLOTS - OPOOL_CACHE_BATCH;
+    opool_t* pool = cache->pool;
+    pthread_mutex_lock(&pool->lock);
+    dstack_push_n(&pool->free, cache->slots, spill);
+    pthread_mutex_unlock(&pool->lock);
+    memmove(cache->slots, cache->slots + spill, sizeof(void*) * OPOOL_CACHE_BATCH);
+    cache->count = OPOOL_CACHE_BATCH;
+  }
+  cache->slots[cache->count++] = obj;
+}
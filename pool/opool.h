@@ -0,0 +1,88 @@
+#ifndef OPOOL_H
+#define OPOOL_H
+
+/*----- System Includes -----*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+/*----- Project Includes -----*/
+
+#include "../dyn_stack/dstack.h"
+
+/*----- Numerical Constants -----*/
+
+// Slots are aligned like malloc's allocations, and slabs
+// start on a cache line.
+#define OPOOL_ALIGN             (2 * sizeof(void*))
+#define OPOOL_SLAB_ALIGN        (64)
+
+// Bytes per slab when the caller doesn't pick a slot count.
+#define OPOOL_SLAB_BYTES        (64 * 1024)
+
+// Slots a per-thread cache holds, and how many it moves
+// to or from the pool at once when it runs dry or fills up.
+#define OPOOL_CACHE_SLOTS       (64)
+#define OPOOL_CACHE_BATCH       (OPOOL_CACHE_SLOTS / 2)
+
+/*----- Type Declarations -----*/
+
+// A pool of fixed size objects.
+// Slots are carved out of slabs, and every free slot's address
+// sits on the free stack, so allocating is a pop and freeing is
+// a push. Freed slots are handed out again last in, first out,
+// while they're still warm in cache. Slabs are only returned when
+// the pool is destroyed.
+//
+// The free stack is reserved to hold every slot the pool owns,
+// so freeing never has to grow it, and can't fail.
+// opool_alloc and opool_free take the pool's lock, and are safe
+// to call from any thread.
+typedef struct object_pool {
+  size_t object_size, slot_size, slab_slots;
+  int64_t capacity;
+  dstack_t free;
+  dstack_t slabs;
+  pthread_mutex_t lock;
+} opool_t;
+
+// A per-thread cache in front of a pool.
+// A cache belongs to a single thread, and allocates and frees
+// without taking the pool's lock, going back to the pool only
+// to move a batch of slots at a time.
+typedef struct opool_cache {
+  opool_t* pool;
+  int64_t count;
+  void* slots[OPOOL_CACHE_SLOTS];
+} opool_cache_t;
+
+/*----- Function Declarations -----*/
+
+// Lifecycle functions
+// slab_slots is how many objects each slab holds, or zero to fit
+// as many as OPOOL_SLAB_BYTES allows.
+// Every cache has to be destroyed before its pool, and destroying
+// a pool releases every object it handed out.
+int opool_init(opool_t* pool, size_t object_size, size_t slab_slots);
+void opool_destroy(opool_t* pool);
+
+// Pool operations
+// Like malloc, opool_alloc sets errno to ENOMEM if it fails, and
+// leaves it alone otherwise. Freeing NULL does nothing.
+// Objects have to go back to the pool they came from.
+void* opool_alloc(opool_t* pool);
+void opool_free(opool_t* pool, void* obj);
+size_t opool_capacity(opool_t* pool);
+size_t opool_available(opool_t* pool);
+
+// Cache operations
+// opool_cache_destroy hands every slot the cache holds back
+// to the pool.
+int opool_cache_init(opool_cache_t* cache, opool_t* pool);
+void opool_cache_destroy(opool_cache_t* cache);
+void* opool_cache_alloc(opool_cache_t* cache);
+void opool_cache_free(opool_cache_t* cache, void* obj);
+
+#endif
@@ -0,0 +1,134 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/*----- Project Includes -----*/
+
+#include "opool.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_OPS           (20000000LL)
+#define BATCH                 (512)
+#define MAX_THREADS           (64)
+
+/*----- Type Declarations -----*/
+
+typedef enum source {
+  SOURCE_MALLOC,
+  SOURCE_POOL,
+  SOURCE_CACHE,
+  SOURCE_COUNT
+} source_t;
+
+typedef struct worker {
+  source_t source;
+  opool_t* pool;
+  size_t size;
+  int64_t rounds;
+} worker_t;
+
+/*----- Globals -----*/
+
+static char const* const source_names[SOURCE_COUNT] = {"malloc", "opool", "opool_cache"};
+static size_t const sizes[] = {16, 32, 64, 128, 256};
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* run(void* arg) {
+  // Allocate a batch of objects, touching each one like a caller
+  // would, then free them all newest first, over and over.
+  worker_t* worker = (worker_t*) arg;
+  opool_cache_t cache;
+  opool_cache_init(&cache, worker->pool);
+  char* objs[BATCH];
+  for (int64_t round = 0; round < worker->rounds; ++round) {
+    for (int i = 0; i < BATCH; ++i) {
+      switch (worker->source) {
+        case SOURCE_MALLOC: objs[i] = malloc(worker->size); break;
+        case SOURCE_POOL: objs[i] = opool_alloc(worker->pool); break;
+        default: objs[i] = opool_cache_alloc(&cache); break;
+      }
+      objs[i][0] = (char) i;
+    }
+    for (int i = BATCH - 1; i >= 0; --i) {
+      switch (worker->source) {
+        case SOURCE_MALLOC: free(objs[i]); break;
+        case SOURCE_POOL: opool_free(worker->pool, objs[i]); break;
+        default: opool_cache_free(&cache, objs[i]); break;
+      }
+    }
+  }
+  opool_cache_destroy(&cache);
+  return NULL;
+}
+
+static double measure(source_t source, size_t size, int threads, int64_t rounds) {
+  opool_t pool;
+  if (opool_init(&pool, size, 0)) {
+    perror("opool_init");
+    exit(EXIT_FAILURE);
+  }
+  pthread_t ids[MAX_THREADS];
+  worker_t workers[MAX_THREADS];
+  double start = now();
+  for (int i = 0; i < threads; ++i) {
+    workers[i] = (worker_t) {source, &pool, size, rounds};
+    if (pthread_create(&ids[i], NULL, run, &workers[i])) {
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
+    }
+  }
+  for (int i = 0; i < threads; ++i) pthread_join(ids[i], NULL);
+  double elapsed = now() - start;
+  opool_destroy(&pool);
+  return elapsed;
+}
+
+int main(int argc, char** argv) {
+  // Usage: pool_bench [threads] [ops]
+  // ops is the number of allocations each thread makes, per
+  // object size and allocator.
+  int threads = 1;
+  int64_t ops = DEFAULT_OPS;
+  if (argc >= 2) threads = atoi(argv[1]);
+  if (argc >= 3) ops = strtoll(argv[2], NULL, 10);
+  if (threads < 1 || ops < BATCH) {
+    fprintf(stderr, "Usage: %s [threads] [ops >= %d]\n", argv[0], BATCH);
+    return EXIT_FAILURE;
+  } else if (threads > MAX_THREADS) {
+    fprintf(stderr, "Running %d threads rather than %d\n", MAX_THREADS, threads);
+    threads = MAX_THREADS;
+  }
+
+  // Each op is an allocation and its matching free.
+  // Every thread makes the same number of ops at the same time, so
+  // wall time over one thread's ops is what each op cost a thread,
+  // contention included, rather than the aggregate throughput.
+  int64_t rounds = ops / BATCH;
+  double per_thread = (double) rounds * BATCH;
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+    double times[SOURCE_COUNT];
+    for (int source = 0; source < SOURCE_COUNT; ++source) {
+      times[source] = measure(source, sizes[i], threads, rounds);
+    }
+    printf("size=%zu threads=%d", sizes[i], threads);
+    for (int source = 0; source < SOURCE_COUNT; ++source) {
+      printf(" %s_ns=%.2f", source_names[source], times[source] * 1e9 / per_thread);
+    }
+    printf(" cache_speedup=%.2fx\n", times[SOURCE_MALLOC] / times[SOURCE_CACHE]);
+  }
+  return 0;
+}
@@ -0,0 +1,141 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/*----- Project Includes -----*/
+
+#include "opool.h"
+
+/*----- Numerical Constants -----*/
+
+#define OBJECT_SIZE       (24)
+#define SLAB_SLOTS        (100)
+#define NUM_OBJECTS       (1000)
+#define NUM_THREADS       (4)
+#define THREAD_ROUNDS     (200)
+
+/*----- Type Declarations -----*/
+
+typedef struct worker {
+  opool_t* pool;
+  uintptr_t id;
+  int ok;
+} worker_t;
+
+/*----- Function Implementations -----*/
+
+static void* churn(void* arg) {
+  // Allocate a batch through our own cache, stamp every object
+  // with our id, make sure nobody else touched them, and free
+  // them all again, over and over.
+  worker_t* worker = (worker_t*) arg;
+  opool_cache_t cache;
+  opool_cache_init(&cache, worker->pool);
+  uintptr_t* objs[NUM_OBJECTS / NUM_THREADS];
+  size_t count = sizeof(objs) / sizeof(objs[0]);
+  worker->ok = 1;
+  for (int round = 0; round < THREAD_ROUNDS; ++round) {
+    for (size_t i = 0; i < count; ++i) {
+      objs[i] = opool_cache_alloc(&cache);
+      if (!objs[i]) worker->ok = 0;
+      else objs[i][0] = objs[i][1] = worker->id;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      if (objs[i] && (objs[i][0] != worker->id || objs[i][1] != worker->id)) worker->ok = 0;
+    }
+    // Free every other one through the pool itself.
+    for (size_t i = 0; i < count; ++i) {
+      if (i % 2) opool_free(worker->pool, objs[i]);
+      else opool_cache_free(&cache, objs[i]);
+    }
+  }
+  opool_cache_destroy(&cache);
+  return NULL;
+}
+
+int main() {
+  // Bad sizes are rejected.
+  opool_t pool;
+  assert(opool_init(NULL, OBJECT_SIZE, 0) == -1 && errno == EINVAL);
+  assert(opool_init(&pool, 0, 0) == -1 && errno == EINVAL);
+
+  // Slots are rounded up to keep every object aligned, and the
+  // default slab fills OPOOL_SLAB_BYTES.
+  assert(!opool_init(&pool, 1, 0));
+  assert(pool.slot_size == OPOOL_ALIGN && pool.slab_slots == OPOOL_SLAB_BYTES / OPOOL_ALIGN);
+  opool_destroy(&pool);
+  assert(!opool_init(&pool, OBJECT_SIZE, SLAB_SLOTS));
+  assert(pool.slot_size == 32);
+  assert(!opool_capacity(&pool) && !opool_available(&pool));
+
+  // Allocate across several slabs. Every object is distinct,
+  // aligned and writable.
+  char* objs[NUM_OBJECTS];
+  for (int i = 0; i < NUM_OBJECTS; ++i) {
+    objs[i] = opool_alloc(&pool);
+    assert(objs[i] && (uintptr_t) objs[i] % OPOOL_ALIGN == 0);
+    memset(objs[i], i & 0xFF, OBJECT_SIZE);
+  }
+  assert(opool_capacity(&pool) == NUM_OBJECTS && !opool_available(&pool));
+  for (int i = 0; i < NUM_OBJECTS; ++i) {
+    for (int j = 0; j < OBJECT_SIZE; ++j) assert(objs[i][j] == (char) (i & 0xFF));
+  }
+
+  // Objects in a slab come out in address order.
+  for (int i = 1; i < SLAB_SLOTS; ++i) assert(objs[i] == objs[i - 1] + pool.slot_size);
+
+  // Freed objects come back last in, first out, and don't
+  // grow the pool.
+  for (int i = 0; i < NUM_OBJECTS; ++i) opool_free(&pool, objs[i]);
+  opool_free(&pool, NULL);
+  assert(opool_available(&pool) == NUM_OBJECTS);
+  for (int i = NUM_OBJECTS - 1; i >= 0; --i) assert(opool_alloc(&pool) == objs[i]);
+  assert(opool_capacity(&pool) == NUM_OBJECTS);
+  for (int i = 0; i < NUM_OBJECTS; ++i) opool_free(&pool, objs[i]);
+
+  // A cache refills and spills in batches, and gives everything
+  // back when it's destroyed.
+  opool_cache_t cache;
+  assert(opool_cache_init(NULL, &pool) == -1 && errno == EINVAL);
+  assert(!opool_cache_init(&cache, &pool));
+  void* first = opool_cache_alloc(&cache);
+  assert(first && cache.count == OPOOL_CACHE_BATCH - 1);
+  assert(opool_available(&pool) == NUM_OBJECTS - OPOOL_CACHE_BATCH);
+  opool_cache_free(&cache, first);
+  assert(opool_cache_alloc(&cache) == first);
+  for (int i = 0; i < NUM_OBJECTS; ++i) objs[i] = opool_cache_alloc(&cache);
+  assert(opool_capacity(&pool) == NUM_OBJECTS + SLAB_SLOTS);
+  for (int i = 0; i < NUM_OBJECTS; ++i) {
+    opool_cache_free(&cache, objs[i]);
+    assert(cache.count <= OPOOL_CACHE_SLOTS);
+  }
+  opool_cache_free(&cache, first);
+  opool_cache_free(&cache, NULL);
+  opool_cache_destroy(&cache);
+  assert(opool_available(&pool) == opool_capacity(&pool));
+
+  // Threads sharing a pool through their own caches never get
+  // handed the same object.
+  pthread_t threads[NUM_THREADS];
+  worker_t workers[NUM_THREADS];
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    workers[i].pool = &pool;
+    workers[i].id = i + 1;
+    assert(!pthread_create(&threads[i], NULL, churn, &workers[i]));
+  }
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    pthread_join(threads[i], NULL);
+    assert(workers[i].ok);
+  }
+  assert(opool_available(&pool) == opool_capacity(&pool));
+
+  // Cleanup and exit.
+  opool_destroy(&pool);
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "prng.h"
+
+/*----- Numerical Constants -----*/
+
+// 26^13 is the largest power of 26 that fits in 64 bits, and 7 copies
+// of it is the largest multiple. A draw below ALPHA_LIMIT holds 13
+// independent, uniformly distributed base 26 digits.
+#define ALPHA_DIGITS          (13)
+#define ALPHA_POWER           (2481152873203736576ULL)
+#define ALPHA_LIMIT           (7 * ALPHA_POWER)
+
+/*----- Function Implementations -----*/
+
+inline static void sanity_check(prng_t const* rng) {
+  // xoshiro can never leave the all zero state.
+  assert(rng->s[0] || rng->s[1] || rng->s[2] || rng->s[3]);
+}
+
+inline static uint64_t rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t splitmix64(uint64_t* state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+void prng_seed(prng_t* rng, uint64_t seed) {
+  for (int i = 0; i < 4; ++i) rng->s[i] = splitmix64(&seed);
+}
+
+uint64_t prng_next(prng_t* rng) {
+  sanity_check(rng);
+  uint64_t* s = rng->s;
+  uint64_t result = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return result;
+}
+
+void prng_jump(prng_t* rng) {
+  // The jump polynomial from the xoshiro reference implementation.
+  static uint64_t const jump[] = {
+    0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+  };
+
+  uint64_t s[4] = {0};
+  for (int i = 0; i < 4; ++i) {
+    for (int b = 0; b < 64; ++b) {
+      if (jump[i] & (1ULL << b)) {
+        for (int j = 0; j < 4; ++j) s[j] ^= rng->s[j];
+      }
+      prng_next(rng);
+    }
+  }
+  memcpy(rng->s, s, sizeof(s));
+}
+
+void prng_stream(prng_t* rng, uint64_t seed, size_t idx) {
+  prng_seed(rng, seed);
+  while (idx--) prng_jump(rng);
+}
+
+uint64_t prng_bounded(prng_t* rng, uint64_t bound) {
+  if (bound <= 1) return 0;
+
+#ifdef __SIZEOF_INT128__
+  // Lemire's multiply and shift. Only draws landing in the first
+  // (2^64 mod bound) low products are rejected, and the modulo is
+  // only needed when the cheap check says we might be in there.
+  __uint128_t product = (__uint128_t) prng_next(rng) * bound;
+  uint64_t low = (uint64_t) product;
+  if (low < bound) {
+    uint64_t threshold = -bound % bound;
+    while (low < threshold) {
+      product = (__uint128_t) prng_next(rng) * bound;
+      low = (uint64_t) product;
+    }
+  }
+  return product >> 64;
+#else
+  // Reject draws from the incomplete final copy of the range.
+  uint64_t threshold = -bound % bound, draw;
+  do {
+    draw = prng_next(rng);
+  } while (draw < threshold);
+  return draw % bound;
+#endif
+}
+
+double prng_double(prng_t* rng) {
+  // The top 53 bits fill a double's mantissa exactly.
+  return (prng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+void prng_fill(prng_t* rng, void* buf, size_t len) {
+  // Whole words first, then whatever is left of the last one.
+  char* curr = (char*) buf;
+  for (; len >= sizeof(uint64_t); len -= sizeof(uint64_t), curr += sizeof(uint64_t)) {
+    uint64_t draw = prng_next(rng);
+    memcpy(curr, &draw, sizeof(draw));
+  }
+  if (len) {
+    uint64_t draw = prng_next(rng);
+    memcpy(curr, &draw, len);
+  }
+}
+
+void prng_alpha(prng_t* rng, char* buf, size_t len) {
+  // Our character set to pull from
+  static char const* alpha = "abcdefghijklmnopqrstuvwxyz";
+
+  // Each accepted draw gives us thirteen letters. Dividing by a
+  // constant compiles down to a multiply, so this is far cheaper
+  // than a draw per letter.
+  while (len) {
+    uint64_t draw = prng_next(rng);
+    if (draw >= ALPHA_LIMIT) continue;
+
+    size_t count = len < ALPHA_DIGITS ? len : ALPHA_DIGITS;
+    for (size_t i = 0; i < count; ++i) {
+      *buf++ = alpha[draw % 26];
+      draw /= 26;
+    }
+    len -= count;
+  }
+}
@@ -0,0 +1,41 @@
+#ifndef PRNG_H
+#define PRNG_H
+
+/*----- System Includes -----*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*----- Type Declarations -----*/
+
+// xoshiro256** state.
+// Generators carry no hidden global state, so giving each thread its
+// own prng_t is all it takes to generate in parallel.
+typedef struct prng {
+  uint64_t s[4];
+} prng_t;
+
+/*----- Function Declarations -----*/
+
+// Seeding
+// prng_seed expands a 64 bit seed with splitmix64, so any seed,
+// including zero, gives a well mixed state.
+// prng_jump advances a generator by 2^128 draws, and prng_stream
+// seeds and then jumps idx times, giving non-overlapping streams
+// for each of a set of workers from a single seed.
+void prng_seed(prng_t* rng, uint64_t seed);
+void prng_jump(prng_t* rng);
+void prng_stream(prng_t* rng, uint64_t seed, size_t idx);
+
+// Draws
+// prng_bounded returns a value in [0, bound) without modulo bias.
+uint64_t prng_next(prng_t* rng);
+uint64_t prng_bounded(prng_t* rng, uint64_t bound);
+double prng_double(prng_t* rng);
+
+// Bulk fills
+// prng_alpha writes len lowercase letters and no terminator.
+void prng_fill(prng_t* rng, void* buf, size_t len);
+void prng_alpha(prng_t* rng, char* buf, size_t len);
+
+#endif
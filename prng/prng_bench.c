@@ -0,0 +1,111 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*----- Project Includes -----*/
+
+#include "prng.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_BYTES         (256 * 1024 * 1024)
+#define SEED                  (42)
+
+/*----- Type Declarations -----*/
+
+typedef struct worker {
+  char* buf;
+  size_t len, idx;
+  pthread_barrier_t* start;
+} worker_t;
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* fill(void* arg) {
+  // Each worker gets its own stream, so there's nothing to share.
+  worker_t* work = (worker_t*) arg;
+  prng_t rng;
+  prng_stream(&rng, SEED, work->idx);
+  pthread_barrier_wait(work->start);
+  prng_alpha(&rng, work->buf, work->len);
+  return NULL;
+}
+
+int main(int argc, char** argv) {
+  // Usage: prng_bench [max threads] [bytes]
+  long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t bytes = DEFAULT_BYTES;
+  if (argc >= 2) max_threads = strtol(argv[1], NULL, 10);
+  if (argc >= 3) bytes = strtoull(argv[2], NULL, 10);
+  if (max_threads < 1) max_threads = 1;
+
+  char* buf = malloc(bytes);
+  pthread_t* threads = malloc(sizeof(pthread_t) * max_threads);
+  worker_t* work = malloc(sizeof(worker_t) * max_threads);
+  if (!buf || !threads || !work) {
+    perror("malloc");
+    return EXIT_FAILURE;
+  }
+
+  // Single threaded, a letter per rand() call against bulk fills.
+  // Touch the buffer first so page faults aren't counted.
+  static char const* alpha = "abcdefghijklmnopqrstuvwxyz";
+  for (size_t i = 0; i < bytes; ++i) buf[i] = 0;
+  double start = now();
+  for (size_t i = 0; i < bytes; ++i) buf[i] = alpha[rand() % 26];
+  double libc = bytes / (now() - start) / 1e6;
+
+  prng_t rng;
+  prng_seed(&rng, SEED);
+  start = now();
+  for (size_t i = 0; i < bytes; ++i) buf[i] = alpha[prng_bounded(&rng, 26)];
+  double bounded = bytes / (now() - start) / 1e6;
+
+  start = now();
+  prng_alpha(&rng, buf, bytes);
+  double bulk = bytes / (now() - start) / 1e6;
+  printf("%zu letters, MB/s: rand() %% 26 %.1f, prng_bounded %.1f, prng_alpha %.1f\n",
+      bytes, libc, bounded, bulk);
+
+  // Double the thread count each round, finishing on max_threads.
+  printf("%8s %12s %8s\n", "threads", "MB/s", "speedup");
+  double base = 0;
+  for (long count = 1;; count = count * 2 < max_threads ? count * 2 : max_threads) {
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, count + 1);
+    size_t share = bytes / count;
+    for (long i = 0; i < count; ++i) {
+      work[i].buf = buf + share * i;
+      work[i].len = i == count - 1 ? bytes - share * i : share;
+      work[i].idx = i;
+      work[i].start = &barrier;
+      pthread_create(&threads[i], NULL, fill, &work[i]);
+    }
+
+    pthread_barrier_wait(&barrier);
+    start = now();
+    for (long i = 0; i < count; ++i) pthread_join(threads[i], NULL);
+    double rate = bytes / (now() - start) / 1e6;
+    pthread_barrier_destroy(&barrier);
+    if (count == 1) base = rate;
+    printf("%8ld %12.1f %8.2f\n", count, rate, rate / base);
+    if (count == max_threads) break;
+  }
+
+  free(work);
+  free(threads);
+  free(buf);
+  return EXIT_SUCCESS;
+}
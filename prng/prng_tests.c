@@ -0,0 +1,88 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "prng.h"
+
+/*----- Numerical Constants -----*/
+
+#define SEED              (42)
+#define NUM_DRAWS         (260000)
+#define NUM_BUCKETS       (26)
+#define BUF_LEN           (100)
+#define PADDING           (16)
+
+/*----- Function Implementations -----*/
+
+int main() {
+  // Known answers, worked out from the reference implementations
+  // of splitmix64 and xoshiro256**.
+  prng_t rng;
+  prng_seed(&rng, SEED);
+  assert(prng_next(&rng) == 0x15780b2e0c2ec716ULL);
+  assert(prng_next(&rng) == 0x6104d9866d113a7eULL);
+  assert(prng_next(&rng) == 0xae17533239e499a1ULL);
+
+  // The same seed always gives the same sequence, and separate
+  // streams from that seed don't.
+  prng_t left, right;
+  prng_seed(&left, SEED);
+  prng_seed(&right, SEED);
+  for (int i = 0; i < 100; ++i) assert(prng_next(&left) == prng_next(&right));
+  prng_stream(&left, SEED, 0);
+  prng_stream(&right, SEED, 1);
+  assert(prng_next(&left) != prng_next(&right));
+  prng_stream(&left, SEED, 1);
+  prng_stream(&right, SEED, 1);
+  assert(prng_next(&left) == prng_next(&right));
+
+  // Bounded draws stay in range, and land in every bucket about
+  // equally often.
+  size_t counts[NUM_BUCKETS] = {0};
+  for (int i = 0; i < NUM_DRAWS; ++i) {
+    uint64_t draw = prng_bounded(&rng, NUM_BUCKETS);
+    assert(draw < NUM_BUCKETS);
+    counts[draw]++;
+  }
+  for (int i = 0; i < NUM_BUCKETS; ++i) {
+    assert(counts[i] > NUM_DRAWS / NUM_BUCKETS * 9 / 10);
+    assert(counts[i] < NUM_DRAWS / NUM_BUCKETS * 11 / 10);
+  }
+  assert(prng_bounded(&rng, 0) == 0);
+  assert(prng_bounded(&rng, 1) == 0);
+  for (int i = 0; i < 100; ++i) assert(prng_bounded(&rng, UINT64_MAX) < UINT64_MAX);
+
+  // Doubles land in [0, 1).
+  for (int i = 0; i < 1000; ++i) {
+    double draw = prng_double(&rng);
+    assert(draw >= 0 && draw < 1);
+  }
+
+  // Bulk fills write exactly len bytes at every length.
+  char buf[BUF_LEN + PADDING];
+  for (size_t len = 0; len <= BUF_LEN; ++len) {
+    memset(buf, '!', sizeof(buf));
+    prng_alpha(&rng, buf, len);
+    for (size_t i = 0; i < len; ++i) assert(buf[i] >= 'a' && buf[i] <= 'z');
+    for (size_t i = len; i < sizeof(buf); ++i) assert(buf[i] == '!');
+
+    memset(buf, '!', sizeof(buf));
+    prng_fill(&rng, buf, len);
+    for (size_t i = len; i < sizeof(buf); ++i) assert(buf[i] == '!');
+  }
+
+  // Every letter should turn up in a long alphabetic fill.
+  size_t letters[NUM_BUCKETS] = {0};
+  for (int i = 0; i < NUM_DRAWS / BUF_LEN; ++i) {
+    prng_alpha(&rng, buf, BUF_LEN);
+    for (size_t j = 0; j < BUF_LEN; ++j) letters[buf[j] - 'a']++;
+  }
+  for (int i = 0; i < NUM_BUCKETS; ++i) {
+    assert(letters[i] > NUM_DRAWS / NUM_BUCKETS * 9 / 10);
+    assert(letters[i] < NUM_DRAWS / NUM_BUCKETS * 11 / 10);
+  }
+  return 0;
+}
@@ -0,0 +1,268 @@
+/*----- System Includes -----*/
+
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define REV_X86
+#include <immintrin.h>
+#endif
+
+/*----- Project Includes -----*/
+
+#include "rev.h"
+
+/*----- Type Declarations -----*/
+
+typedef void (*kernel_fn) (char* dst, char const* src, size_t len);
+
+// A kernel along with its name, so that selecting one is a single
+// pointer store, and the two can never be seen out of step.
+typedef struct kernel_entry {
+  rev_kernel_t id;
+  kernel_fn fn;
+} kernel_entry_t;
+
+/*----- Function Implementations -----*/
+
+static void rev_scalar(char* dst, char const* src, size_t len) {
+  // Reverse eight bytes at a time by swapping them from both
+  // ends towards the middle. Byte-swapping a 64-bit word reverses
+  // its bytes, so each step is two loads, two swaps and two stores.
+  // Loading both ends before storing either keeps this safe in place.
+  size_t lo = 0, hi = len;
+  while (hi - lo >= 16) {
+    uint64_t front, back;
+    memcpy(&front, src + lo, 8);
+    memcpy(&back, src + hi - 8, 8);
+    front = __builtin_bswap64(front);
+    back = __builtin_bswap64(back);
+    memcpy(dst + lo, &back, 8);
+    memcpy(dst + hi - 8, &front, 8);
+    lo += 8;
+    hi -= 8;
+  }
+
+  // Finish the middle a byte at a time.
+  while (hi > lo) {
+    char front = src[lo], back = src[--hi];
+    dst[lo++] = back;
+    dst[hi] = front;
+  }
+}
+
+#ifdef REV_X86
+
+__attribute__((target("sse2")))
+static inline __m128i reverse_sse2(__m128i x) {
+  // SSE2 has no byte shuffle, so we get there in steps.
+  // Swap the bytes in every 16-bit word, reverse the words in
+  // each 64-bit half, then swap the halves.
+  x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+  x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+  x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+  return _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+__attribute__((target("sse2")))
+static void rev_sse2(char* dst, char const* src, size_t len) {
+  // Same shape as the scalar kernel, sixteen bytes at a time.
+  size_t lo = 0, hi = len;
+  while (hi - lo >= 32) {
+    __m128i front = _mm_loadu_si128((__m128i const*) (src + lo));
+    __m128i back = _mm_loadu_si128((__m128i const*) (src + hi - 16));
+    _mm_storeu_si128((__m128i*) (dst + lo), reverse_sse2(back));
+    _mm_storeu_si128((__m128i*) (dst + hi - 16), reverse_sse2(front));
+    lo += 16;
+    hi -= 16;
+  }
+  rev_scalar(dst + lo, src + lo, hi - lo);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i reverse_avx2(__m256i x) {
+  // Byte shuffles only work within each 128-bit lane, so
+  // reverse both lanes, then swap them.
+  __m256i mask = _mm256_setr_epi8(
+      15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+      15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  x = _mm256_shuffle_epi8(x, mask);
+  return _mm256_permute2x128_si256(x, x, 1);
+}
+
+__attribute__((target("avx2")))
+static void rev_avx2(char* dst, char const* src, size_t len) {
+  // Same shape as the scalar kernel, thirty two bytes at a time.
+  size_t lo = 0, hi = len;
+  while (hi - lo >= 64) {
+    __m256i front = _mm256_loadu_si256((__m256i const*) (src + lo));
+    __m256i back = _mm256_loadu_si256((__m256i const*) (src + hi - 32));
+    _mm256_storeu_si256((__m256i*) (dst + lo), reverse_avx2(back));
+    _mm256_storeu_si256((__m256i*) (dst + hi - 32), reverse_avx2(front));
+    lo += 32;
+    hi -= 32;
+  }
+  rev_sse2(dst + lo, src + lo, hi - lo);
+}
+
+#endif
+
+static int supported(rev_kernel_t kernel) {
+  switch (kernel) {
+    case REV_KERNEL_SCALAR:
+      return 1;
+#ifdef REV_X86
+    case REV_KERNEL_SSE2:
+      return __builtin_cpu_supports("sse2");
+    case REV_KERNEL_AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return 0;
+  }
+}
+
+static kernel_entry_t const scalar_entry = {REV_KERNEL_SCALAR, rev_scalar};
+#ifdef REV_X86
+static kernel_entry_t const sse2_entry = {REV_KERNEL_SSE2, rev_sse2};
+static kernel_entry_t const avx2_entry = {REV_KERNEL_AVX2, rev_avx2};
+#endif
+
+// NULL until the first selection. Every thread that races to make
+// the automatic choice makes the same one, so whichever store lands
+// last is as good as any other.
+static _Atomic(kernel_entry_t const*) selected = NULL;
+
+int rev_select_kernel(rev_kernel_t requested) {
+  // Pick the best supported kernel for REV_KERNEL_AUTO.
+  if (requested == REV_KERNEL_AUTO) {
+    requested = REV_KERNEL_SCALAR;
+    if (supported(REV_KERNEL_SSE2)) requested = REV_KERNEL_SSE2;
+    if (supported(REV_KERNEL_AVX2)) requested = REV_KERNEL_AVX2;
+  } else if (!supported(requested)) {
+    errno = ENOTSUP;
+    return -1;
+  }
+
+  kernel_entry_t const* entry;
+  switch (requested) {
+#ifdef REV_X86
+    case REV_KERNEL_SSE2:
+      entry = &sse2_entry;
+      break;
+    case REV_KERNEL_AVX2:
+      entry = &avx2_entry;
+      break;
+#endif
+    default:
+      entry = &scalar_entry;
+      break;
+  }
+  atomic_store_explicit(&selected, entry, memory_order_release);
+  return 0;
+}
+
+inline static kernel_entry_t const* current_kernel(void) {
+  kernel_entry_t const* entry = atomic_load_explicit(&selected, memory_order_acquire);
+  if (!entry) {
+    rev_select_kernel(REV_KERNEL_AUTO);
+    entry = atomic_load_explicit(&selected, memory_order_acquire);
+  }
+  return entry;
+}
+
+rev_kernel_t rev_active_kernel(void) {
+  return current_kernel()->id;
+}
+
+void rev_bytes(char* dst, char const* src, size_t len) {
+  current_kernel()->fn(dst, src, len);
+}
+
+inline static int is_continuation(unsigned char byte) {
+  return (byte & 0xc0) == 0x80;
+}
+
+static size_t decode(unsigned char const* str, size_t len, uint32_t* cp) {
+  // Decode one code point, returning how many bytes it used.
+  // Anything malformed is treated as a single byte.
+  size_t need = str[0] < 0x80 ? 1 : str[0] >= 0xf0 ? 4 : str[0] >= 0xe0 ? 3 : str[0] >= 0xc0 ? 2 : 0;
+  if (!need || need > len) {
+    *cp = str[0];
+    return 1;
+  }
+
+  uint32_t val = need == 1 ? str[0] : str[0] & (0x7f >> need);
+  for (size_t i = 1; i < need; ++i) {
+    if (!is_continuation(str[i])) {
+      *cp = str[0];
+      return 1;
+    }
+    val = (val << 6) | (str[i] & 0x3f);
+  }
+  *cp = val;
+  return need;
+}
+
+inline static int is_regional(uint32_t cp) {
+  return cp >= 0x1f1e6 && cp <= 0x1f1ff;
+}
+
+inline static int is_extend(uint32_t cp) {
+  // Combining marks, variation selectors, emoji skin tone
+  // modifiers and the zero width joiner all attach to
+  // whatever came before them.
+  return (cp >= 0x300 && cp <= 0x36f) || (cp >= 0x1ab0 && cp <= 0x1aff)
+    || (cp >= 0x1dc0 && cp <= 0x1dff) || (cp >= 0x20d0 && cp <= 0x20ff)
+    || (cp >= 0xfe20 && cp <= 0xfe2f) || (cp >= 0xfe00 && cp <= 0xfe0f)
+    || (cp >= 0x1f3fb && cp <= 0x1f3ff) || (cp >= 0xe0100 && cp <= 0xe01ef)
+    || cp == 0x200d;
+}
+
+static size_t next_unit(unsigned char const* str, size_t len, rev_unit_t unit) {
+  // Work out how many bytes the next unit, starting at str, spans.
+  uint32_t cp;
+  size_t used = decode(str, len, &cp);
+  if (unit == REV_CODEPOINTS) return used;
+
+  // A pair of regional indicators is a single flag.
+  uint32_t next;
+  if (is_regional(cp) && used < len) {
+    size_t more = decode(str + used, len - used, &next);
+    if (is_regional(next)) used += more;
+  }
+
+  // Swallow anything that extends this character. A zero width
+  // joiner also pulls in the character after it.
+  while (used < len) {
+    size_t more = decode(str + used, len - used, &next);
+    if (!is_extend(next)) break;
+    used += more;
+    if (next == 0x200d && used < len) used += decode(str + used, len - used, &next);
+  }
+  return used;
+}
+
+void rev_utf8(char* dst, char const* src, size_t len, rev_unit_t unit) {
+  unsigned char const* str = (unsigned char const*) src;
+  if (dst != src) {
+    // Out of place, copy each unit straight to its mirrored position.
+    for (size_t pos = 0; pos < len;) {
+      size_t used = next_unit(str + pos, len - pos, unit);
+      memcpy(dst + (len - pos - used), src + pos, used);
+      pos += used;
+    }
+    return;
+  }
+
+  // In place, reverse the bytes within each unit, and then
+  // reverse the whole buffer, which puts every unit's bytes back
+  // in order, but the units themselves in reverse.
+  for (size_t pos = 0; pos < len;) {
+    size_t used = next_unit(str + pos, len - pos, unit);
+    rev_scalar(dst + pos, src + pos, used);
+    pos += used;
+  }
+  rev_bytes(dst, dst, len);
+}
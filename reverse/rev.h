@@ -0,0 +1,49 @@
+#ifndef REV_H
+#define REV_H
+
+/*----- System Includes -----*/
+
+#include <errno.h>
+#include <stddef.h>
+
+/*----- Type Declarations -----*/
+
+// Byte reversal kernels. REV_KERNEL_AUTO picks the fastest one
+// the CPU supports, the first time a reversal runs.
+typedef enum rev_kernel {
+  REV_KERNEL_AUTO,
+  REV_KERNEL_SCALAR,
+  REV_KERNEL_SSE2,
+  REV_KERNEL_AVX2
+} rev_kernel_t;
+
+// What a UTF-8 reversal keeps together.
+// Code points keep multi-byte sequences intact. Graphemes also keep
+// combining marks, variation selectors, emoji modifiers, zero width
+// joiner sequences and regional indicator pairs (flags) attached to
+// the character they belong to. That covers the common cases of
+// Unicode's extended grapheme clusters, but not every rule, such as
+// Hangul syllable composition.
+typedef enum rev_unit {
+  REV_CODEPOINTS,
+  REV_GRAPHEMES
+} rev_unit_t;
+
+/*----- Function Declarations -----*/
+
+// Kernel selection
+// rev_select_kernel fails with ENOTSUP if the CPU can't run the kernel.
+// Selection is atomic, so it's safe to race with reversals on other
+// threads, which use either the old kernel or the new one.
+int rev_select_kernel(rev_kernel_t kernel);
+rev_kernel_t rev_active_kernel(void);
+
+// Reversal
+// Both functions run in place when dst == src, and otherwise
+// require that dst and src don't overlap. Neither needs, or
+// writes, a null terminator. Invalid UTF-8 bytes are treated
+// as single-byte characters.
+void rev_bytes(char* dst, char const* src, size_t len);
+void rev_utf8(char* dst, char const* src, size_t len, rev_unit_t unit);
+
+#endif
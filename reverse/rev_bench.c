@@ -0,0 +1,68 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "rev.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_MAX_BYTES     (1024 * 1024 * 1024)
+#define MIN_BYTES             (16)
+
+// Repeat small sizes until we've moved at least this much,
+// so that timer resolution doesn't swamp the result.
+#define BYTES_PER_SIZE        (256 * 1024 * 1024)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+  // Usage: rev_bench [max bytes]
+  size_t max = DEFAULT_MAX_BYTES;
+  if (argc >= 2) max = strtoull(argv[1], NULL, 10);
+  if (max < MIN_BYTES) max = MIN_BYTES;
+
+  char* src = malloc(max);
+  char* dst = malloc(max);
+  if (!src || !dst) {
+    perror("malloc");
+    return 1;
+  }
+  memset(src, 'a', max);
+  memset(dst, 0, max);
+
+  char const* names[] = {"auto", "scalar", "sse2", "avx2"};
+  rev_kernel_t kernels[] = {REV_KERNEL_SCALAR, REV_KERNEL_SSE2, REV_KERNEL_AVX2};
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(*kernels); ++k) {
+    if (rev_select_kernel(kernels[k])) continue;
+    for (size_t len = MIN_BYTES; len <= max; len *= 4) {
+      size_t reps = len < BYTES_PER_SIZE ? BYTES_PER_SIZE / len : 1;
+      double start = now();
+      for (size_t i = 0; i < reps; ++i) {
+        // Alternate buffers so that every pass depends on the last.
+        if (i & 1) rev_bytes(src, dst, len);
+        else rev_bytes(dst, src, len);
+      }
+      double elapsed = now() - start;
+      printf("kernel=%s bytes=%zu gb_per_sec=%.2f\n",
+          names[kernels[k]], len, (double) len * reps / elapsed / 1e9);
+      if (len > max / 4) break;
+    }
+  }
+
+  free(dst);
+  free(src);
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "rev.h"
+
+/*----- Numerical Constants -----*/
+
+#define MAX_LEN           (300)
+#define PADDING           (64)
+
+/*----- Function Implementations -----*/
+
+void naive_reverse(char* dst, char const* src, size_t len) {
+  for (size_t i = 0; i < len; ++i) dst[len - i - 1] = src[i];
+}
+
+void check_utf8(char const* in, char const* expected, rev_unit_t unit) {
+  // Check both the out of place and the in place paths.
+  size_t len = strlen(in);
+  char out[64] = {0}, buf[64] = {0};
+  rev_utf8(out, in, len, unit);
+  assert(!memcmp(out, expected, len));
+  memcpy(buf, in, len);
+  rev_utf8(buf, buf, len, unit);
+  assert(!memcmp(buf, expected, len));
+}
+
+int main() {
+  // Random input, padded on both sides, so we can check
+  // that nothing is written out of bounds.
+  char src[MAX_LEN + PADDING], dst[MAX_LEN + PADDING * 2], expected[MAX_LEN];
+  for (size_t i = 0; i < sizeof(src); ++i) src[i] = rand();
+
+  // Every kernel the CPU supports should match the naive version
+  // at every length, and at every alignment.
+  rev_kernel_t kernels[] = {REV_KERNEL_SCALAR, REV_KERNEL_SSE2, REV_KERNEL_AVX2};
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(*kernels); ++k) {
+    if (rev_select_kernel(kernels[k])) {
+      assert(errno == ENOTSUP);
+      continue;
+    }
+    assert(rev_active_kernel() == kernels[k]);
+    for (size_t len = 0; len <= MAX_LEN; ++len) {
+      for (size_t offset = 0; offset < 4; ++offset) {
+        char const* in = src + offset;
+        naive_reverse(expected, in, len);
+
+        // Out of place.
+        memset(dst, '#', sizeof(dst));
+        rev_bytes(dst + PADDING + offset, in, len);
+        assert(!memcmp(dst + PADDING + offset, expected, len));
+        for (size_t i = 0; i < PADDING + offset; ++i) assert(dst[i] == '#');
+        for (size_t i = PADDING + offset + len; i < sizeof(dst); ++i) assert(dst[i] == '#');
+
+        // In place.
+        memcpy(dst + offset, in, len);
+        rev_bytes(dst + offset, dst + offset, len);
+        assert(!memcmp(dst + offset, expected, len));
+      }
+    }
+  }
+  rev_select_kernel(REV_KERNEL_AUTO);
+
+  // Code points keep their bytes in order.
+  check_utf8("h\xc3\xa9llo", "oll\xc3\xa9h", REV_CODEPOINTS);
+  check_utf8("a\xe2\x82\xac\xf0\x9f\x98\x80", "\xf0\x9f\x98\x80\xe2\x82\xac" "a", REV_CODEPOINTS);
+
+  // A combining accent stays on its letter as a grapheme,
+  // but not as a code point.
+  check_utf8("ae\xcc\x81", "e\xcc\x81" "a", REV_GRAPHEMES);
+  check_utf8("ae\xcc\x81", "\xcc\x81" "ea", REV_CODEPOINTS);
+
+  // Flags, skin tones and zero width joiner sequences stay whole.
+  char const* flag = "\xf0\x9f\x87\xaf\xf0\x9f\x87\xb5";
+  char const* wave = "\xf0\x9f\x91\x8b\xf0\x9f\x8f\xbd";
+  char const* family = "\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x91\xa7";
+  char in[64], out[64];
+  strcpy(in, flag);
+  strcat(in, "x");
+  strcat(in, wave);
+  strcat(in, family);
+  strcpy(out, family);
+  strcat(out, wave);
+  strcat(out, "x");
+  strcat(out, flag);
+  check_utf8(in, out, REV_GRAPHEMES);
+
+  // Malformed bytes are reversed as single characters.
+  check_utf8("a\xff\xc3", "\xc3\xff" "a", REV_GRAPHEMES);
+  return 0;
+}
@@ -3,6 +3,12 @@
 #include <stdio.h>
 #include <errno.h>
 
+/*----- Project Header Files -----*/
+
+#include "../arena/arena.h"
+#include "rev.h"
+#include "strprim.h"
+
 /*----- Numerical Constants -----*/
 
 #define HEAP_SIZE           4096
@@ -13,21 +19,17 @@ static void* malloc(size_t len) {
   // Static buffers will stay in scope for the full
   // life of the program.
   static char buffer[HEAP_SIZE];
-  static char* curr = buffer;
+  static arena_t heap;
+  static int ready;
 
-  // Check if we have any space left.
-  if ((curr + len) - buffer < HEAP_SIZE) {
-    // Return the current value of the allocation pointer
-    // and then increment it so that the next allocation
-    // will grab a different bit of memory.
-    void* section = curr;
-    curr += len;
-    return section;
-  } else {
-    // Out of space, return failure and set errno accordingly.
-    errno = ENOMEM;
-    return NULL;
+  // Hand the buffer to a static arena the first time through.
+  // The arena bumps an allocation pointer forward for us,
+  // and sets errno to ENOMEM once the buffer runs out.
+  if (!ready) {
+    arena_init_static(&heap, buffer, HEAP_SIZE);
+    ready = 1;
   }
+  return arena_alloc(&heap, len);
 }
 
 static void free(void* ptr) {
@@ -35,42 +37,20 @@ static void free(void* ptr) {
 }
 
 static size_t strlen(char const* str) {
-  // Make a copy of our pointer, walk it forward
-  // until we hit the null terminator, then use
-  // pointer arithmetic to work out how far we walked.
-  char const* curr = str;
-  while (*curr) curr++;
-  return curr - str;
+  // Scans a word or a vector at a time rather than a byte.
+  return str_len(str);
 }
 
 static char* strdup(char const* str) {
   // Find out how large the string is
   // and allocate enough memory to copy it.
-  size_t len = strlen(str) + 1;
-  char* buff = (char*) malloc(sizeof(char) * len);
+  size_t len = strlen(str);
+  char* buff = (char*) malloc(sizeof(char) * (len + 1));
   if (!buff) return NULL;
 
-  // Walk both pointers forward and copy as we go.
-  while (*str) *buff++ = *str++;
-
-  // Null terminate and return.
-  buff[len] = '\0';
-  return buff;
-}
-
-char* do_reverse(char const* in, char* out) {
-  // Check if our incoming pointer has hit
-  // the null terminator yet.
-  if (*in) {
-    // Not at the end of the string yet, recurse.
-    out = do_reverse(in + 1, out);
-    *out = *in;
-    return out + 1;
-  } else {
-    // Base case, in points at the null terminator,
-    // which means we've reached the end of the string.
-    return out;
-  }
+  // Copy the characters and null terminate at buff[len],
+  // the last byte we allocated, and return the start of it.
+  return str_copy_n(buff, str, len);
 }
 
 char* reverse(char const* str) {
@@ -80,7 +60,9 @@ char* reverse(char const* str) {
   if (!reversed) return NULL;
 
   // Reverse it and return.
-  do_reverse(str, reversed);
+  // rev_bytes works iteratively, so unlike a recursive reversal
+  // its stack usage doesn't grow with the length of the string.
+  rev_bytes(reversed, str, strlen(str));
   return reversed;
 }
 
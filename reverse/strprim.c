@@ -0,0 +1,145 @@
+/*----- System Includes -----*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STRPRIM_X86
+#include <emmintrin.h>
+#endif
+
+/*----- Project Includes -----*/
+
+#include "strprim.h"
+
+/*----- Numerical Constants -----*/
+
+#define ONES            ((uintptr_t) -1 / 0xff)
+#define HIGHS           (ONES * 0x80)
+
+/*----- Macro Definitions -----*/
+
+// Reading a whole aligned block can run past the end of the
+// allocation the string lives in. That can't fault, since an
+// aligned block never straddles a page, but AddressSanitizer
+// can't know that.
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NO_ASAN __attribute__((no_sanitize_address))
+#endif
+#elif defined(__SANITIZE_ADDRESS__)
+#define NO_ASAN __attribute__((no_sanitize_address))
+#endif
+#ifndef NO_ASAN
+#define NO_ASAN
+#endif
+
+/*----- Function Implementations -----*/
+
+size_t str_len_bytewise(char const* str) {
+  // Make a copy of our pointer, walk it forward
+  // until we hit the null terminator, then use
+  // pointer arithmetic to work out how far we walked.
+  char const* curr = str;
+  while (*curr) curr++;
+  return curr - str;
+}
+
+inline static int has_zero(uintptr_t word) {
+  // Subtracting one from every byte only borrows into a byte's
+  // high bit when that byte was zero (or already had its high
+  // bit set, which the mask rules out).
+  return ((word - ONES) & ~word & HIGHS) != 0;
+}
+
+NO_ASAN size_t str_len_word(char const* str) {
+  // Walk bytewise until we're aligned to a word.
+  char const* curr = str;
+  while ((uintptr_t) curr % sizeof(uintptr_t)) {
+    if (!*curr) return curr - str;
+    ++curr;
+  }
+
+  // Then check a whole word at a time.
+  // Each word goes through memcpy rather than a uintptr_t pointer,
+  // which would break strict aliasing. It still compiles down
+  // to a single aligned load.
+  for (;;) {
+    uintptr_t word;
+    memcpy(&word, curr, sizeof(word));
+    if (has_zero(word)) break;
+    curr += sizeof(word);
+  }
+
+  // Find which byte of the word it was.
+  while (*curr) ++curr;
+  return curr - str;
+}
+
+#ifdef STRPRIM_X86
+
+NO_ASAN size_t str_len_sse2(char const* str) {
+  // Round down to a 16 byte boundary, and mask off any
+  // matches from before the start of the string.
+  uintptr_t offset = (uintptr_t) str % 16;
+  __m128i const* block = (__m128i const*) (str - offset);
+  __m128i zero = _mm_setzero_si128();
+  unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero)) >> offset;
+  if (mask) return __builtin_ctz(mask);
+
+  // Compare sixteen bytes at a time until we're aligned to 64.
+  ++block;
+  while ((uintptr_t) block % 64) {
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero));
+    if (mask) return (char const*) block + __builtin_ctz(mask) - str;
+    ++block;
+  }
+
+  // Then four blocks, a whole cache line, per iteration. The unsigned
+  // minimum of the four is zero exactly when one of them holds a zero.
+  for (;; block += 4) {
+    __m128i low = _mm_min_epu8(_mm_load_si128(block), _mm_load_si128(block + 1));
+    __m128i high = _mm_min_epu8(_mm_load_si128(block + 2), _mm_load_si128(block + 3));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(low, high), zero))) break;
+  }
+
+  // Work out which block it was in.
+  while (!(mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero)))) ++block;
+  return (char const*) block + __builtin_ctz(mask) - str;
+}
+
+#else
+
+size_t str_len_sse2(char const* str) {
+  return str_len_word(str);
+}
+
+#endif
+
+size_t str_len(char const* str) {
+#ifdef STRPRIM_X86
+  // SSE2 is part of the x86-64 baseline.
+  return str_len_sse2(str);
+#else
+  return str_len_word(str);
+#endif
+}
+
+char* str_copy_n(char* dst, char const* src, size_t len) {
+  // Copy the characters, then terminate right after them.
+  memcpy(dst, src, len);
+  dst[len] = '\0';
+  return dst;
+}
+
+char* str_dup(char const* str) {
+  // Find out how large the string is, with the fast scan, and
+  // allocate enough memory to copy it and its terminator.
+  size_t len = str_len(str) + 1;
+  char* buff = (char*) malloc(len);
+  if (!buff) return NULL;
+
+  // The terminator comes along with the rest of the string.
+  return memcpy(buff, str, len);
+}
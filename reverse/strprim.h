@@ -0,0 +1,28 @@
+#ifndef STRPRIM_H
+#define STRPRIM_H
+
+/*----- System Includes -----*/
+
+#include <stddef.h>
+
+/*----- Function Declarations -----*/
+
+// Length
+// str_len picks the fastest of the others for this machine.
+// The word and SSE2 versions read whole aligned blocks, so they
+// can look at a few bytes past the terminator, but never past
+// the end of the page it lives on.
+size_t str_len(char const* str);
+size_t str_len_bytewise(char const* str);
+size_t str_len_word(char const* str);
+size_t str_len_sse2(char const* str);
+
+// Copying
+// str_copy_n copies exactly len bytes and then terminates dst,
+// so dst must have room for len + 1 bytes.
+// str_dup allocates with malloc, and copies the string and its
+// terminator in a single memcpy.
+char* str_copy_n(char* dst, char const* src, size_t len);
+char* str_dup(char const* str);
+
+#endif
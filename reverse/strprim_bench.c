@@ -0,0 +1,93 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "strprim.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_MAX_BYTES     (64 * 1024 * 1024)
+#define MIN_BYTES             (16)
+
+// Repeat small sizes until we've scanned at least this much,
+// so that timer resolution doesn't swamp the result.
+#define BYTES_PER_SIZE        (256 * 1024 * 1024)
+
+/*----- Type Declarations -----*/
+
+typedef size_t (*len_fn)(char const*);
+typedef char* (*dup_fn)(char const*);
+
+/*----- Globals -----*/
+
+// Written after every call so the optimizer can't throw them away.
+static volatile size_t sink;
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t libc_strlen(char const* str) {
+  return strlen(str);
+}
+
+static char* libc_strdup(char const* str) {
+  return strdup(str);
+}
+
+static double time_len(len_fn fn, char const* str, size_t len, size_t reps) {
+  double start = now();
+  for (size_t i = 0; i < reps; ++i) sink = fn(str);
+  return (len + 1) * (double) reps / (now() - start) / 1e9;
+}
+
+static double time_dup(dup_fn fn, char const* str, size_t len, size_t reps) {
+  double start = now();
+  for (size_t i = 0; i < reps; ++i) {
+    char* copy = fn(str);
+    sink = copy[len / 2];
+    free(copy);
+  }
+  return (len + 1) * (double) reps / (now() - start) / 1e9;
+}
+
+int main(int argc, char** argv) {
+  // Usage: strprim_bench [max bytes]
+  size_t max = DEFAULT_MAX_BYTES;
+  if (argc >= 2) max = strtoull(argv[1], NULL, 10);
+  if (max < MIN_BYTES) max = MIN_BYTES;
+
+  char* str = malloc(max + 1);
+  if (!str) {
+    perror("malloc");
+    return EXIT_FAILURE;
+  }
+  memset(str, 'a', max);
+
+  // All figures are GB/s.
+  printf("%12s %10s %10s %10s %10s %10s %10s\n",
+      "bytes", "bytewise", "word", "sse2", "libc", "str_dup", "strdup");
+  for (size_t len = MIN_BYTES; len <= max; len *= 4) {
+    size_t reps = BYTES_PER_SIZE / len;
+    if (!reps) reps = 1;
+    str[len] = '\0';
+    printf("%12zu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", len,
+        time_len(str_len_bytewise, str, len, reps), time_len(str_len_word, str, len, reps),
+        time_len(str_len_sse2, str, len, reps), time_len(libc_strlen, str, len, reps),
+        time_dup(str_dup, str, len, reps), time_dup(libc_strdup, str, len, reps));
+    str[len] = 'a';
+  }
+  free(str);
+  return EXIT_SUCCESS;
+}
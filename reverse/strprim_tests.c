@@ -0,0 +1,78 @@
+/*----- System Includes -----*/
+
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/*----- Project Includes -----*/
+
+#include "strprim.h"
+
+/*----- Numerical Constants -----*/
+
+#define MAX_LEN           (300)
+#define ALIGNMENTS        (32)
+#define CANARY            ((char) 0xa5)
+
+/*----- Type Declarations -----*/
+
+typedef size_t (*len_fn)(char const*);
+
+/*----- Function Implementations -----*/
+
+int main() {
+  len_fn lens[] = {str_len, str_len_bytewise, str_len_word, str_len_sse2};
+  size_t num_lens = sizeof(lens) / sizeof(*lens);
+
+  // Every length function should agree with libc at every
+  // length and alignment.
+  char buf[ALIGNMENTS + MAX_LEN + 1];
+  for (size_t align = 0; align < ALIGNMENTS; ++align) {
+    for (size_t len = 0; len <= MAX_LEN; ++len) {
+      memset(buf, 'x', sizeof(buf));
+      buf[align + len] = '\0';
+      for (size_t i = 0; i < num_lens; ++i) assert(lens[i](buf + align) == len);
+    }
+  }
+
+  // Strings that end right before an unmapped page must not fault,
+  // however the block reads line up against them.
+  long page = sysconf(_SC_PAGESIZE);
+  char* map = mmap(NULL, page * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  assert(map != MAP_FAILED);
+  assert(!mprotect(map + page, page, PROT_NONE));
+  for (size_t len = 0; len < MAX_LEN; ++len) {
+    char* str = map + page - len - 1;
+    memset(str, 'y', len);
+    str[len] = '\0';
+    for (size_t i = 0; i < num_lens; ++i) assert(lens[i](str) == len);
+  }
+  munmap(map, page * 2);
+
+  // str_copy_n should write exactly len + 1 bytes, and nothing
+  // past the terminator.
+  char src[MAX_LEN + 1], dst[MAX_LEN + 2];
+  memset(src, 'z', MAX_LEN);
+  src[MAX_LEN] = '\0';
+  for (size_t len = 0; len <= MAX_LEN; ++len) {
+    memset(dst, CANARY, sizeof(dst));
+    assert(str_copy_n(dst, src, len) == dst);
+    assert(!memcmp(dst, src, len));
+    assert(dst[len] == '\0');
+    assert(dst[len + 1] == CANARY);
+  }
+
+  // str_dup should return the start of the copy, terminated.
+  for (size_t len = 0; len <= MAX_LEN; ++len) {
+    char* copy = str_dup(src + MAX_LEN - len);
+    assert(copy);
+    assert(strlen(copy) == len);
+    assert(!strcmp(copy, src + MAX_LEN - len));
+    free(copy);
+  }
+  return 0;
+}
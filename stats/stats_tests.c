@@ -0,0 +1,123 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/*----- Project Includes -----*/
+
+#include "stkstats.h"
+#include "../dyn_stack/dstack.h"
+#include "../dyn_stack/dstack_inline.h"
+#include "../gen_stack/gstack.h"
+#include "../gen_stack/gstack_inline.h"
+
+/*----- Numerical Constants -----*/
+
+#define NUM_RECORDS       (1000)
+#define DUMP_PATH         "stats_tests.prom"
+#define DUMP_DIR          "stats_tests.dir"
+#define MAX_LINE          (256)
+
+/*----- Function Implementations -----*/
+
+static size_t count_lines(char const* path, char const* prefix) {
+  // Count the lines in a dump that start with prefix.
+  FILE* in = fopen(path, "r");
+  assert(in);
+  char line[MAX_LINE];
+  size_t count = 0;
+  while (fgets(line, sizeof(line), in)) {
+    if (!strncmp(line, prefix, strlen(prefix))) ++count;
+  }
+  fclose(in);
+  return count;
+}
+
+int main() {
+  // Every stack registers its counters for as long as it lives.
+  size_t base = stkstats_count();
+  dstack_t dstk;
+  gstack_t gstk;
+  assert(!dstack_init(&dstk, sizeof(int64_t), NULL));
+  assert(!gstack_init(&gstk, sizeof(int64_t)));
+  assert(stkstats_count() == base + 2);
+
+  // Pushes, pops and growth all show up, through every path.
+  stkstats_t stats;
+  for (int64_t i = 0; i < NUM_RECORDS; ++i) {
+    assert(!dstack_push(&dstk, &i));
+    assert(!gstack_push_inline(&gstk, &i));
+  }
+  int64_t batch[NUM_RECORDS];
+  for (int64_t i = 0; i < NUM_RECORDS; ++i) batch[i] = i;
+  assert(!dstack_push_n(&dstk, batch, NUM_RECORDS));
+  assert(!dstack_pop_n(&dstk, NUM_RECORDS / 2));
+  for (int64_t i = 0; i < NUM_RECORDS / 4; ++i) {
+    assert(!dstack_pop_inline(&dstk));
+    assert(!gstack_pop(&gstk));
+  }
+
+  assert(!dstack_stats(&dstk, &stats));
+  assert(!strcmp(stats.kind, "dstack") && stats.record_size == sizeof(int64_t));
+  assert(stats.pushes == 2 * NUM_RECORDS);
+  assert(stats.pops == NUM_RECORDS / 2 + NUM_RECORDS / 4);
+  assert(stats.depth == dstack_size(&dstk));
+  assert(stats.high_water == 2 * NUM_RECORDS);
+  assert(stats.extends > 0 && stats.bytes_copied > 0 && stats.grow_ticks > 0);
+  assert(!stats.prev && !stats.next);
+
+  // Reserving grows the stack too, and counts like any other growth.
+  uint64_t grown = stats.extends, copied = stats.bytes_copied;
+  size_t before = dstack_capacity(&dstk);
+  assert(!dstack_reserve(&dstk, before * 4));
+  assert(!dstack_stats(&dstk, &stats));
+  assert(stats.extends == grown + 1);
+  assert(stats.bytes_copied == copied + before * sizeof(int64_t));
+
+  // The first move out of a gstack's inline buffer copies exactly
+  // the records in it, and doubling from there moves every byte
+  // of the old buffer.
+  assert(!gstack_stats(&gstk, &stats));
+  assert(!strcmp(stats.kind, "gstack"));
+  assert(stats.pushes == NUM_RECORDS && stats.pops == NUM_RECORDS / 4);
+  assert(stats.depth == gstack_size(&gstk) && stats.high_water == NUM_RECORDS);
+  uint64_t expected = 0, capacity = GSTACK_INLINE_SIZE / sizeof(int64_t);
+  int64_t extends = 0;
+  for (; capacity < NUM_RECORDS; capacity *= 2, ++extends) expected += capacity * sizeof(int64_t);
+  assert(stats.extends == (uint64_t) extends && stats.bytes_copied == expected);
+
+  // A gstack_t can be moved, and keeps counting.
+  gstack_t moved = gstk;
+  int64_t val = 0;
+  assert(!gstack_push(&moved, &val));
+  assert(!gstack_stats(&moved, &stats) && stats.pushes == NUM_RECORDS + 1);
+
+  // The dump holds a sample per stack for each metric.
+  assert(!stkstats_dump(DUMP_PATH));
+  assert(count_lines(DUMP_PATH, "# TYPE ") == 7);
+  assert(count_lines(DUMP_PATH, "stack_pushes_total{kind=\"dstack\"") == 1);
+  assert(count_lines(DUMP_PATH, "stack_pushes_total{kind=\"gstack\"") == 1);
+  assert(count_lines(DUMP_PATH, "stack_high_water{") == base + 2);
+  assert(stkstats_dump(NULL) && errno == EINVAL);
+  assert(stkstats_dump("no/such/dir/stats.prom") && errno == ENOENT);
+  assert(!mkdir(DUMP_DIR, 0755));
+  errno = ENOSPC;
+  assert(stkstats_dump(DUMP_DIR) && errno == EISDIR);
+  assert(!rmdir(DUMP_DIR));
+
+  // Destroyed stacks drop out of the registry, and later dumps.
+  dstack_destroy(&dstk);
+  gstack_destroy(&moved);
+  assert(stkstats_count() == base);
+  assert(!stkstats_dump(DUMP_PATH));
+  assert(count_lines(DUMP_PATH, "stack_high_water{") == base);
+  remove(DUMP_PATH);
+  assert(dstack_stats(NULL, &stats) && errno == EINVAL);
+  return 0;
+}
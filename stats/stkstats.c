@@ -0,0 +1,152 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*----- Project Includes -----*/
+
+#include "stkstats.h"
+
+/*----- Numerical Constants -----*/
+
+#define STKSTATS_TMP_SUFFIX       ".tmp"
+
+/*----- Type Declarations -----*/
+
+typedef struct stkstats_metric {
+  char const* name;
+  char const* help;
+  char const* type;
+  size_t offset;
+} stkstats_metric_t;
+
+/*----- Globals -----*/
+
+// Every live stack's counters, in a list guarded by the lock.
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static stkstats_t* registry;
+static size_t registered;
+static uint64_t next_id;
+
+static stkstats_metric_t const metrics[] = {
+  {"stack_pushes_total", "Records pushed.", "counter", offsetof(stkstats_t, pushes)},
+  {"stack_pops_total", "Records popped.", "counter", offsetof(stkstats_t, pops)},
+  {"stack_depth", "Records on the stack right now.", "gauge", offsetof(stkstats_t, depth)},
+  {"stack_high_water", "Deepest the stack has been.", "gauge", offsetof(stkstats_t, high_water)},
+  {"stack_extends_total", "Times the stack grew.", "counter", offsetof(stkstats_t, extends)},
+  {"stack_grow_copied_bytes_total", "Bytes carried over by growth.", "counter",
+    offsetof(stkstats_t, bytes_copied)},
+  {"stack_grow_ticks_total", "Ticks spent growing.", "counter", offsetof(stkstats_t, grow_ticks)}
+};
+
+/*----- Function Implementations -----*/
+
+stkstats_t* stkstats_register(char const* kind, size_t record_size) {
+  stkstats_t* stats = calloc(1, sizeof(stkstats_t));
+  if (!stats) return NULL;
+  stats->kind = kind;
+  stats->record_size = record_size;
+
+  // Link it in at the head.
+  pthread_mutex_lock(&registry_lock);
+  stats->id = next_id++;
+  stats->next = registry;
+  if (registry) registry->prev = stats;
+  registry = stats;
+  ++registered;
+  pthread_mutex_unlock(&registry_lock);
+  return stats;
+}
+
+void stkstats_unregister(stkstats_t* stats) {
+  if (!stats) return;
+  pthread_mutex_lock(&registry_lock);
+  if (stats->prev) stats->prev->next = stats->next;
+  else registry = stats->next;
+  if (stats->next) stats->next->prev = stats->prev;
+  --registered;
+  pthread_mutex_unlock(&registry_lock);
+  free(stats);
+}
+
+size_t stkstats_count(void) {
+  pthread_mutex_lock(&registry_lock);
+  size_t count = registered;
+  pthread_mutex_unlock(&registry_lock);
+  return count;
+}
+
+static void write_metrics(FILE* out) {
+  // One block per metric, with a sample for every stack.
+  size_t num_metrics = sizeof(metrics) / sizeof(metrics[0]);
+  for (size_t i = 0; i < num_metrics; ++i) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s %s\n",
+        metrics[i].name, metrics[i].help, metrics[i].name, metrics[i].type);
+    for (stkstats_t* stats = registry; stats; stats = stats->next) {
+      uint64_t value = *(uint64_t const*) ((char const*) stats + metrics[i].offset);
+      fprintf(out, "%s{kind=\"%s\",id=\"%" PRIu64 "\",record_size=\"%zu\"} %" PRIu64 "\n",
+          metrics[i].name, stats->kind, stats->id, stats->record_size, value);
+    }
+  }
+}
+
+int stkstats_dump(char const* path) {
+  // Check error conditions.
+  if (!path) {
+    errno = EINVAL;
+    return -1;
+  }
+  size_t len = strlen(path);
+  char* tmp = malloc(len + sizeof(STKSTATS_TMP_SUFFIX));
+  if (!tmp) {
+    errno = ENOMEM;
+    return -1;
+  }
+  memcpy(tmp, path, len);
+  memcpy(tmp + len, STKSTATS_TMP_SUFFIX, sizeof(STKSTATS_TMP_SUFFIX));
+
+  // Write everything out under the lock, so no stack comes
+  // or goes halfway through.
+  FILE* out = fopen(tmp, "w");
+  if (!out) {
+    free(tmp);
+    return -1;
+  }
+  pthread_mutex_lock(&registry_lock);
+  write_metrics(out);
+  pthread_mutex_unlock(&registry_lock);
+
+  // Only swap the new dump in once it's all there.
+  // Each step records its own error, so we never report
+  // whatever errno happened to hold before.
+  int err = ferror(out) ? EIO : 0;
+  if (fclose(out) && !err) err = EIO;
+  if (!err && rename(tmp, path)) err = errno;
+  if (err) {
+    remove(tmp);
+    free(tmp);
+    errno = err;
+    return -1;
+  }
+  free(tmp);
+  errno = 0;
+  return 0;
+}
+
+uint64_t stkstats_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
@@ -0,0 +1,87 @@
+#ifndef STKSTATS_H
+#define STKSTATS_H
+
+/*----- System Includes -----*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+/*----- Type Declarations -----*/
+
+// Hot path counters for a single stack.
+// Stacks only carry these when built with -DSTACK_STATS (make
+// STATS=1), and every translation unit has to agree on that, as
+// it changes the layout of dstack_t and gstack_t. Without it, the
+// counting compiles away to nothing.
+//
+// Each stack owns its counters, but they live in a process-wide
+// registry rather than inside the stack, so that a gstack_t can
+// still be moved around in memory, and so the registry can dump
+// every live stack at once.
+// Growth is timed in ticks, which are cycles on x86, and
+// nanoseconds everywhere else.
+typedef struct stkstats {
+  char const* kind;
+  uint64_t id;
+  size_t record_size;
+  uint64_t pushes, pops;
+  uint64_t depth, high_water;
+  uint64_t extends, bytes_copied, grow_ticks;
+  struct stkstats *prev, *next;
+} stkstats_t;
+
+/*----- Function Declarations -----*/
+
+// Registry functions
+// stkstats_register returns NULL if it can't allocate the
+// counters, in which case the stack just goes uncounted.
+stkstats_t* stkstats_register(char const* kind, size_t record_size);
+void stkstats_unregister(stkstats_t* stats);
+size_t stkstats_count(void);
+
+// stkstats_dump writes every live stack's counters to path in the
+// Prometheus text format. It writes a temporary file next to path
+// and renames it over path, so a reader never sees a partial dump.
+// The counters aren't atomic, so a dump taken while other threads
+// are using their stacks may be slightly behind.
+int stkstats_dump(char const* path);
+
+// A cheap timestamp, for timing growth.
+uint64_t stkstats_ticks(void);
+
+/*----- Function Implementations -----*/
+
+inline static void stkstats_push(stkstats_t* stats, uint64_t count, uint64_t depth) {
+  if (!stats) return;
+  stats->pushes += count;
+  stats->depth = depth;
+  if (depth > stats->high_water) stats->high_water = depth;
+}
+
+inline static void stkstats_pop(stkstats_t* stats, uint64_t count, uint64_t depth) {
+  if (!stats) return;
+  stats->pops += count;
+  stats->depth = depth;
+}
+
+inline static void stkstats_grow(stkstats_t* stats, uint64_t bytes, uint64_t ticks) {
+  if (!stats) return;
+  ++stats->extends;
+  stats->bytes_copied += bytes;
+  stats->grow_ticks += ticks;
+}
+
+/*----- Macro Definitions -----*/
+
+// What the stacks call on their hot paths, so that a build
+// without STACK_STATS doesn't even evaluate the arguments.
+#ifdef STACK_STATS
+#define STKSTATS_PUSH(stats, count, depth)  stkstats_push(stats, count, depth)
+#define STKSTATS_POP(stats, count, depth)   stkstats_pop(stats, count, depth)
+#else
+#define STKSTATS_PUSH(stats, count, depth)  ((void) 0)
+#define STKSTATS_POP(stats, count, depth)   ((void) 0)
+#endif
+
+#endif
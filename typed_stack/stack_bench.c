@@ -0,0 +1,115 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*----- Project Includes -----*/
+
+#include "tstack.h"
+#include "../dyn_stack/dstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_RECORDS       (10000000LL)
+
+/*----- Type Declarations -----*/
+
+typedef struct rec8 { char bytes[8]; } rec8_t;
+typedef struct rec16 { char bytes[16]; } rec16_t;
+typedef struct rec64 { char bytes[64]; } rec64_t;
+typedef struct rec256 { char bytes[256]; } rec256_t;
+
+DEFINE_STACK(stack8, rec8_t)
+DEFINE_STACK(stack16, rec16_t)
+DEFINE_STACK(stack64, rec64_t)
+DEFINE_STACK(stack256, rec256_t)
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(char const* impl, size_t size, int64_t records,
+    double push, double pop, unsigned sum) {
+  printf("impl=%s record_size=%zu push_ns=%.2f peek_pop_ns=%.2f checksum=%u\n",
+      impl, size, push * 1e9 / records, pop * 1e9 / records, sum);
+}
+
+// Pushes records copies of a record, then peeks and pops them all,
+// timing each phase, using the stack generated for the given type.
+#define BENCH_TYPED(name, type)                                               \
+  static void bench_##name(int64_t records) {                                 \
+    name##_t stk;                                                             \
+    name##_init(&stk);                                                        \
+    type rec;                                                                 \
+    memset(&rec, 1, sizeof(rec));                                             \
+                                                                              \
+    double start = now();                                                     \
+    for (int64_t i = 0; i < records; ++i) {                                   \
+      rec.bytes[0] = (char) i;                                                \
+      name##_push(&stk, &rec);                                                \
+    }                                                                         \
+    double push = now() - start;                                              \
+                                                                              \
+    unsigned sum = 0;                                                         \
+    start = now();                                                            \
+    while (name##_size(&stk)) {                                               \
+      sum += name##_peek(&stk)->bytes[0];                                     \
+      name##_pop(&stk);                                                       \
+    }                                                                         \
+    report(#name, sizeof(type), records, push, now() - start, sum);           \
+    name##_destroy(&stk);                                                     \
+  }
+
+BENCH_TYPED(stack8, rec8_t)
+BENCH_TYPED(stack16, rec16_t)
+BENCH_TYPED(stack64, rec64_t)
+BENCH_TYPED(stack256, rec256_t)
+
+static void bench_dstack(int64_t records, size_t size) {
+  // Same workload as above, through the generic dstack.
+  dstack_t stk;
+  dstack_init(&stk, size, NULL);
+  char rec[256];
+  memset(rec, 1, sizeof(rec));
+
+  double start = now();
+  for (int64_t i = 0; i < records; ++i) {
+    rec[0] = (char) i;
+    dstack_push(&stk, rec);
+  }
+  double push = now() - start;
+
+  unsigned sum = 0;
+  start = now();
+  while (dstack_size(&stk)) {
+    sum += *(char*) dstack_peek(&stk);
+    dstack_pop(&stk);
+  }
+  report("dstack", size, records, push, now() - start, sum);
+  dstack_destroy(&stk);
+}
+
+int main(int argc, char** argv) {
+  // Usage: stack_bench [records]
+  int64_t records = DEFAULT_RECORDS;
+  if (argc >= 2) records = strtoll(argv[1], NULL, 10);
+
+  // Bigger records need fewer of them to take the same time,
+  // and to keep memory in check.
+  bench_stack8(records);
+  bench_dstack(records, sizeof(rec8_t));
+  bench_stack16(records);
+  bench_dstack(records, sizeof(rec16_t));
+  bench_stack64(records / 4);
+  bench_dstack(records / 4, sizeof(rec64_t));
+  bench_stack256(records / 16);
+  bench_dstack(records / 16, sizeof(rec256_t));
+  return 0;
+}
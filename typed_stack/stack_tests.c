@@ -0,0 +1,72 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "tstack.h"
+
+/*----- Numerical Constants -----*/
+
+#define NUM_RECORDS       (10000)
+
+/*----- Type Declarations -----*/
+
+typedef struct point {
+  double x, y;
+} point_t;
+
+DEFINE_STACK(istack, int64_t)
+DEFINE_STACK(pstack, point_t)
+
+/*----- Function Implementations -----*/
+
+int main() {
+  // Initialize a stack of integers.
+  istack_t ints;
+  int err = istack_init(&ints);
+  assert(!err);
+
+  // Push well past the initial capacity.
+  for (int64_t val = 0; val < NUM_RECORDS; ++val) {
+    err = istack_push(&ints, &val);
+    assert(!err);
+  }
+  assert(istack_size(&ints) == NUM_RECORDS);
+  assert(istack_capacity(&ints) >= NUM_RECORDS);
+
+  // Pop things off the stack and ensure things
+  // come out in the right order.
+  int64_t val = NUM_RECORDS;
+  while (istack_size(&ints)) {
+    assert(*istack_peek(&ints) + 1 == val--);
+    err = istack_pop(&ints);
+    assert(!err);
+  }
+  assert(val == 0);
+  assert(!istack_peek(&ints));
+  assert(errno == ENOENT);
+  assert(istack_pop(&ints) && errno == ENOENT);
+  istack_destroy(&ints);
+
+  // Struct records should be copied whole.
+  pstack_t points;
+  err = pstack_init(&points);
+  assert(!err);
+  for (int i = 0; i < NUM_RECORDS; ++i) {
+    point_t curr = {i, -i};
+    err = pstack_push(&points, &curr);
+    assert(!err);
+  }
+  for (int i = NUM_RECORDS - 1; i >= 0; --i) {
+    point_t const* curr = pstack_peek(&points);
+    assert(curr->x == i && curr->y == -i);
+    pstack_pop(&points);
+  }
+  assert(!pstack_size(&points));
+
+  // Cleanup and exit.
+  pstack_destroy(&points);
+  return 0;
+}
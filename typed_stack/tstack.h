@@ -0,0 +1,102 @@
+#ifndef TSTACK_H
+#define TSTACK_H
+
+/*----- System Includes -----*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+/*----- Numerical Constants -----*/
+
+#define TSTACK_BASE                 (-1)
+#define TSTACK_INIT_CAPACITY        (8)
+
+/*----- Macro Definitions -----*/
+
+// Generates a stack specialized for a single record type.
+// DEFINE_STACK(istack, int64_t) declares istack_t along with
+// istack_init, istack_destroy, istack_push, istack_peek,
+// istack_pop, istack_size and istack_capacity.
+//
+// Unlike dstack, the record size is a compile-time constant,
+// so pushes are plain assignments the compiler can turn into
+// a handful of loads and stores, rather than a call to memcpy.
+// Everything is static inline, so every translation unit that
+// expands the macro gets its own copy to inline.
+//
+// Like the other stacks, failures return -1 (or NULL) and set
+// errno, but successful operations leave errno untouched, so the
+// fast path never writes to thread-local storage.
+#define DEFINE_STACK(name, type)                                              \
+  typedef struct name {                                                       \
+    int64_t pos, capacity;                                                    \
+    type* buffer;                                                             \
+  } name##_t;                                                                 \
+                                                                              \
+  static inline int name##_init(name##_t* stk) {                              \
+    if (!stk) {                                                               \
+      errno = EINVAL;                                                         \
+      return -1;                                                              \
+    }                                                                         \
+    stk->pos = TSTACK_BASE;                                                   \
+    stk->capacity = TSTACK_INIT_CAPACITY;                                     \
+    stk->buffer = (type*) malloc(sizeof(type) * TSTACK_INIT_CAPACITY);        \
+    return stk->buffer ? 0 : -1;                                              \
+  }                                                                           \
+                                                                              \
+  static inline void name##_destroy(name##_t* stk) {                          \
+    free(stk->buffer);                                                        \
+  }                                                                           \
+                                                                              \
+  /* Growth is the slow path, keep it out of the inlined push. */             \
+  /* Marked unused, as a stack that's never pushed to never calls it. */      \
+  __attribute__((noinline, unused))                                           \
+  static int name##_extend(name##_t* stk) {                                   \
+    if ((size_t) stk->capacity > SIZE_MAX / 2 / sizeof(type)) {               \
+      errno = ENOMEM;                                                         \
+      return -1;                                                              \
+    }                                                                         \
+    int64_t target = stk->capacity * 2;                                       \
+    type* tmp = (type*) realloc(stk->buffer, sizeof(type) * target);          \
+    if (!tmp) return -1;                                                      \
+    stk->buffer = tmp;                                                        \
+    stk->capacity = target;                                                   \
+    return 0;                                                                 \
+  }                                                                           \
+                                                                              \
+  static inline int name##_push(name##_t* stk, type const* val) {             \
+    int64_t target = stk->pos + 1;                                            \
+    if (target == stk->capacity && name##_extend(stk)) return -1;             \
+    stk->buffer[target] = *val;                                               \
+    stk->pos = target;                                                        \
+    return 0;                                                                 \
+  }                                                                           \
+                                                                              \
+  static inline type* name##_peek(name##_t* stk) {                            \
+    if (stk->pos < 0) {                                                       \
+      errno = ENOENT;                                                         \
+      return NULL;                                                            \
+    }                                                                         \
+    return &stk->buffer[stk->pos];                                            \
+  }                                                                           \
+                                                                              \
+  static inline int name##_pop(name##_t* stk) {                               \
+    if (stk->pos == TSTACK_BASE) {                                            \
+      errno = ENOENT;                                                         \
+      return -1;                                                              \
+    }                                                                         \
+    --stk->pos;                                                               \
+    return 0;                                                                 \
+  }                                                                           \
+                                                                              \
+  static inline size_t name##_size(name##_t const* stk) {                     \
+    return stk->pos + 1;                                                      \
+  }                                                                           \
+                                                                              \
+  static inline size_t name##_capacity(name##_t const* stk) {                 \
+    return stk->capacity;                                                     \
+  }
+
+#endif
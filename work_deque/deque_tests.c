@@ -0,0 +1,99 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+/*----- Project Includes -----*/
+
+#include "wsdeque.h"
+
+/*----- Numerical Constants -----*/
+
+#define NUM_RECORDS       (1000)
+#define NUM_THIEVES       (3)
+#define NUM_STOLEN        (200000)
+
+/*----- Type Declarations -----*/
+
+typedef struct thief {
+  wsdeque_t* dq;
+  atomic_int* done;
+  char* seen;
+} thief_t;
+
+/*----- Function Implementations -----*/
+
+void* steal(void* arg) {
+  // Steal until the owner tells us to stop.
+  thief_t* thief = (thief_t*) arg;
+  while (!atomic_load(thief->done) || wsdeque_size(thief->dq)) {
+    int64_t val;
+    if (!wsdeque_steal(thief->dq, &val)) {
+      assert(!thief->seen[val]);
+      thief->seen[val] = 1;
+    } else {
+      assert(errno == ENOENT || errno == EAGAIN);
+    }
+  }
+  return NULL;
+}
+
+int main() {
+  // Initialize a deque.
+  wsdeque_t dq;
+  int err = wsdeque_init(&dq, sizeof(int64_t));
+  assert(!err);
+
+  // Push well past the initial capacity.
+  for (int64_t val = 0; val < NUM_RECORDS; ++val) {
+    err = wsdeque_push(&dq, &val);
+    assert(!err);
+  }
+  assert(wsdeque_size(&dq) == NUM_RECORDS);
+
+  // The owner pops LIFO, while thieves take from the other end.
+  int64_t val;
+  err = wsdeque_pop(&dq, &val);
+  assert(!err && val == NUM_RECORDS - 1);
+  err = wsdeque_steal(&dq, &val);
+  assert(!err && val == 0);
+  for (int64_t i = 1; i < NUM_RECORDS - 1; ++i) {
+    err = wsdeque_steal(&dq, &val);
+    assert(!err && val == i);
+  }
+  assert(wsdeque_pop(&dq, &val) && errno == ENOENT);
+  assert(wsdeque_steal(&dq, &val) && errno == ENOENT);
+
+  // Now race a set of thieves against the owner.
+  // Every record pushed should come out exactly once.
+  char* seen = calloc(NUM_STOLEN, 1);
+  atomic_int done = 0;
+  pthread_t threads[NUM_THIEVES];
+  thief_t thieves[NUM_THIEVES];
+  for (int i = 0; i < NUM_THIEVES; ++i) {
+    thieves[i] = (thief_t) {&dq, &done, seen};
+    pthread_create(&threads[i], NULL, steal, &thieves[i]);
+  }
+
+  // The owner pushes everything, popping every third record itself.
+  // The thieves and the owner write disjoint entries of seen.
+  char* mine = calloc(NUM_STOLEN, 1);
+  for (int64_t i = 0; i < NUM_STOLEN; ++i) {
+    err = wsdeque_push(&dq, &i);
+    assert(!err);
+    if (i % 3 == 0 && !wsdeque_pop(&dq, &val)) {
+      assert(!mine[val]);
+      mine[val] = 1;
+    }
+  }
+  atomic_store(&done, 1);
+  for (int i = 0; i < NUM_THIEVES; ++i) pthread_join(threads[i], NULL);
+  for (int64_t i = 0; i < NUM_STOLEN; ++i) assert(seen[i] + mine[i] == 1);
+
+  // Cleanup and exit.
+  free(mine);
+  free(seen);
+  wsdeque_destroy(&dq);
+  return 0;
+}
@@ -0,0 +1,165 @@
+/*----- System Includes -----*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*----- Project Includes -----*/
+
+#include "wsdeque.h"
+
+/*----- Numerical Constants -----*/
+
+#define DEFAULT_BYTES         (256 * 1024 * 1024)
+#define GRAIN                 (64 * 1024)
+
+/*----- Type Declarations -----*/
+
+// Reverse len bytes of in into out.
+typedef struct task {
+  char const* in;
+  char* out;
+  size_t len;
+} task_t;
+
+typedef struct pool pool_t;
+
+typedef struct worker {
+  pool_t* pool;
+  wsdeque_t dq;
+  unsigned seed;
+  long id;
+} worker_t;
+
+struct pool {
+  worker_t* workers;
+  long count;
+  atomic_size_t remaining;
+  pthread_barrier_t start;
+};
+
+/*----- Function Implementations -----*/
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void do_reverse(char const* in, char* out, size_t len) {
+  // Iterative leaf version of reverse/simple.c's do_reverse.
+  for (size_t i = 0; i < len; ++i) out[len - i - 1] = in[i];
+}
+
+static void run_task(worker_t* self, task_t task) {
+  // Split recursively, the way do_reverse recurses, but push one half
+  // onto our deque where idle workers can steal it.
+  // Reversing the front half of the input fills the back half of
+  // the output, and vice versa.
+  while (task.len > GRAIN) {
+    size_t half = task.len / 2;
+    task_t front = {task.in, task.out + (task.len - half), half};
+    if (wsdeque_push(&self->dq, &front)) {
+      // Couldn't grow the deque, just do the work here.
+      do_reverse(front.in, front.out, front.len);
+      atomic_fetch_sub(&self->pool->remaining, front.len);
+    }
+    task = (task_t) {task.in + half, task.out, task.len - half};
+  }
+  do_reverse(task.in, task.out, task.len);
+  atomic_fetch_sub(&self->pool->remaining, task.len);
+}
+
+static void* work(void* arg) {
+  worker_t* self = (worker_t*) arg;
+  pool_t* pool = self->pool;
+  pthread_barrier_wait(&pool->start);
+
+  // Run our own tasks LIFO, and steal from a random
+  // victim once we run out, until every byte is done.
+  task_t task;
+  while (atomic_load(&pool->remaining)) {
+    if (!wsdeque_pop(&self->dq, &task)) {
+      run_task(self, task);
+    } else if (pool->count > 1) {
+      long victim = rand_r(&self->seed) % pool->count;
+      if (victim != self->id && !wsdeque_steal(&pool->workers[victim].dq, &task)) {
+        run_task(self, task);
+      }
+    }
+  }
+  return NULL;
+}
+
+static double run(char const* in, char* out, size_t len, long count) {
+  pool_t pool = {.count = count};
+  pool.workers = malloc(sizeof(worker_t) * count);
+  atomic_init(&pool.remaining, len);
+  pthread_barrier_init(&pool.start, NULL, count + 1);
+  for (long i = 0; i < count; ++i) {
+    pool.workers[i] = (worker_t) {.pool = &pool, .seed = i + 1, .id = i};
+    wsdeque_init(&pool.workers[i].dq, sizeof(task_t));
+  }
+
+  // Seed the first worker with the whole job, and let
+  // stealing spread it across everyone else.
+  task_t root = {in, out, len};
+  wsdeque_push(&pool.workers[0].dq, &root);
+  pthread_t* threads = malloc(sizeof(pthread_t) * count);
+  for (long i = 0; i < count; ++i) pthread_create(&threads[i], NULL, work, &pool.workers[i]);
+  pthread_barrier_wait(&pool.start);
+  double begin = now();
+  for (long i = 0; i < count; ++i) pthread_join(threads[i], NULL);
+  double elapsed = now() - begin;
+
+  for (long i = 0; i < count; ++i) wsdeque_destroy(&pool.workers[i].dq);
+  pthread_barrier_destroy(&pool.start);
+  free(threads);
+  free(pool.workers);
+  return elapsed;
+}
+
+int main(int argc, char** argv) {
+  // Usage: parallel_reverse [max threads] [bytes]
+  long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t len = DEFAULT_BYTES;
+  if (argc >= 2) max_threads = strtol(argv[1], NULL, 10);
+  if (argc >= 3) len = strtoull(argv[2], NULL, 10);
+  if (max_threads < 1) max_threads = 1;
+
+  char* in = malloc(len);
+  char* out = malloc(len);
+  if (!in || !out) {
+    perror("malloc");
+    return 1;
+  }
+  for (size_t i = 0; i < len; ++i) in[i] = 'a' + i % 26;
+
+  double base = 0;
+  for (long count = 1;; count = count * 2 < max_threads ? count * 2 : max_threads) {
+    // Wipe the previous run's output, so every run has to
+    // produce the whole reversal on its own to pass the check.
+    memset(out, 0, len);
+    double elapsed = run(in, out, len, count);
+    if (count == 1) base = elapsed;
+
+    // Make sure the work actually got done.
+    for (size_t i = 0; i < len; ++i) {
+      if (out[len - i - 1] != in[i]) {
+        fprintf(stderr, "Mismatch at byte %zu\n", i);
+        return 1;
+      }
+    }
+    printf("threads=%ld bytes=%zu seconds=%.3f gb_per_sec=%.2f speedup=%.2f\n",
+        count, len, elapsed, len / elapsed / 1e9, base / elapsed);
+    if (count == max_threads) break;
+  }
+  free(out);
+  free(in);
+  return 0;
+}
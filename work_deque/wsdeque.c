@@ -0,0 +1,180 @@
+/*----- System Includes -----*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----- Project Includes -----*/
+
+#include "wsdeque.h"
+
+/*----- Numerical Constants -----*/
+
+#define WSDEQUE_INIT_CAPACITY             (64)
+
+/*----- Function Implementations -----*/
+
+inline static void sanity_check(wsdeque_t const* dq) {
+  // Make sure our basic invariants hold.
+  assert(dq && atomic_load_explicit(&dq->buffer, memory_order_relaxed));
+}
+
+inline static void* calc_ptr(wsdeque_t const* dq, wsdeque_buffer_t* buf, int64_t pos) {
+  return buf->records + ((size_t) (pos & buf->mask) * dq->record_size);
+}
+
+static wsdeque_buffer_t* alloc_buffer(size_t record_size, int64_t capacity) {
+  // Keep the ring and its header in one allocation,
+  // so that retiring a ring is a single pointer.
+  wsdeque_buffer_t* buf = malloc(sizeof(wsdeque_buffer_t) + record_size * capacity);
+  if (!buf) return NULL;
+  buf->mask = capacity - 1;
+  buf->records = (char*) (buf + 1);
+  return buf;
+}
+
+static wsdeque_buffer_t* extend_deque(wsdeque_t* dq, wsdeque_buffer_t* old, int64_t top, int64_t bottom) {
+  // Double the ring, and copy the live records across.
+  // Records keep their logical positions, so thieves that
+  // already loaded top don't need to know anything happened.
+  wsdeque_buffer_t* buf = alloc_buffer(dq->record_size, (old->mask + 1) * 2);
+  if (!buf) return NULL;
+  for (int64_t pos = top; pos < bottom; ++pos) {
+    memcpy(calc_ptr(dq, buf, pos), calc_ptr(dq, old, pos), dq->record_size);
+  }
+
+  // Thieves may still be reading the old ring, so hold onto it.
+  if (dstack_push(&dq->retired, &old)) {
+    free(buf);
+    return NULL;
+  }
+  atomic_store_explicit(&dq->buffer, buf, memory_order_release);
+  return buf;
+}
+
+int wsdeque_init(wsdeque_t* dq, size_t record_size) {
+  if (!dq || !record_size) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  dq->record_size = record_size;
+  if (dstack_init(&dq->retired, sizeof(wsdeque_buffer_t*), NULL)) return -1;
+  wsdeque_buffer_t* buf = alloc_buffer(record_size, WSDEQUE_INIT_CAPACITY);
+  if (!buf) {
+    dstack_destroy(&dq->retired);
+    return -1;
+  }
+
+  atomic_init(&dq->top, 0);
+  atomic_init(&dq->bottom, 0);
+  atomic_init(&dq->buffer, buf);
+  return 0;
+}
+
+void wsdeque_destroy(wsdeque_t* dq) {
+  // Free every ring we've ever used.
+  while (dstack_size(&dq->retired)) {
+    free(*(wsdeque_buffer_t**) dstack_peek(&dq->retired));
+    dstack_pop(&dq->retired);
+  }
+  dstack_destroy(&dq->retired);
+  free(atomic_load_explicit(&dq->buffer, memory_order_relaxed));
+}
+
+int wsdeque_push(wsdeque_t* dq, void const* val) {
+  // Check error conditions.
+  sanity_check(dq);
+  if (!val) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  int64_t bottom = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+  int64_t top = atomic_load_explicit(&dq->top, memory_order_acquire);
+  wsdeque_buffer_t* buf = atomic_load_explicit(&dq->buffer, memory_order_relaxed);
+  if (bottom - top > buf->mask) {
+    // We've hit our current capacity.
+    buf = extend_deque(dq, buf, top, bottom);
+    if (!buf) return -1;
+  }
+
+  // Write the record, then publish it to thieves.
+  memcpy(calc_ptr(dq, buf, bottom), val, dq->record_size);
+  atomic_store_explicit(&dq->bottom, bottom + 1, memory_order_release);
+  return 0;
+}
+
+int wsdeque_pop(wsdeque_t* dq, void* out) {
+  // Check error conditions.
+  sanity_check(dq);
+
+  // Claim the bottom record before looking at top.
+  // The full fence orders our claim against a concurrent
+  // thief's read of bottom.
+  int64_t bottom = atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+  wsdeque_buffer_t* buf = atomic_load_explicit(&dq->buffer, memory_order_relaxed);
+  atomic_store_explicit(&dq->bottom, bottom, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t top = atomic_load_explicit(&dq->top, memory_order_relaxed);
+
+  if (top > bottom) {
+    // Deque was empty, put bottom back.
+    atomic_store_explicit(&dq->bottom, bottom + 1, memory_order_relaxed);
+    errno = ENOENT;
+    return -1;
+  }
+
+  if (out) memcpy(out, calc_ptr(dq, buf, bottom), dq->record_size);
+  if (top == bottom) {
+    // This is the last record, so we race thieves for it
+    // the same way they race each other, through top.
+    int won = atomic_compare_exchange_strong_explicit(&dq->top, &top, top + 1,
+        memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&dq->bottom, bottom + 1, memory_order_relaxed);
+    if (!won) {
+      errno = ENOENT;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int wsdeque_steal(wsdeque_t* dq, void* out) {
+  // Check error conditions.
+  sanity_check(dq);
+  if (!out) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  int64_t top = atomic_load_explicit(&dq->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t bottom = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+  if (top >= bottom) {
+    errno = ENOENT;
+    return -1;
+  }
+
+  // Copy the record out before claiming it. The owner can't
+  // reuse this slot until top moves past it, so if our exchange
+  // succeeds, what we copied is what was pushed.
+  wsdeque_buffer_t* buf = atomic_load_explicit(&dq->buffer, memory_order_acquire);
+  memcpy(out, calc_ptr(dq, buf, top), dq->record_size);
+  if (!atomic_compare_exchange_strong_explicit(&dq->top, &top, top + 1,
+        memory_order_seq_cst, memory_order_relaxed)) {
+    errno = EAGAIN;
+    return -1;
+  }
+  return 0;
+}
+
+size_t wsdeque_size(wsdeque_t const* dq) {
+  // Check error conditions.
+  sanity_check(dq);
+
+  // Only a snapshot when thieves are active.
+  int64_t bottom = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+  int64_t top = atomic_load_explicit(&dq->top, memory_order_relaxed);
+  return bottom > top ? (size_t) (bottom - top) : 0;
+}
@@ -0,0 +1,61 @@
+#ifndef WSDEQUE_H
+#define WSDEQUE_H
+
+/*----- System Includes -----*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <inttypes.h>
+
+/*----- Project Includes -----*/
+
+#include "../dyn_stack/dstack.h"
+
+/*----- Type Declarations -----*/
+
+// A ring of records, laid out the same way as a dstack buffer:
+// record i lives at records + (i & mask) * record_size.
+typedef struct wsdeque_buffer {
+  int64_t mask;
+  char* records;
+} wsdeque_buffer_t;
+
+// A Chase-Lev work-stealing deque.
+// The owning thread pushes and pops at the bottom, LIFO, like a
+// dstack, while any other thread can steal from the top.
+// The owner's operations only synchronize with thieves when the
+// deque is down to its last record.
+//
+// The ring is laid out like a dstack buffer and doubles the same
+// way, but it can't simply be a dstack: dstack grows with realloc,
+// which frees the old buffer while thieves may still be reading it,
+// and its single size counter can't express separate top and bottom
+// indices. So the deque keeps its own ring, and only reuses dstack
+// to hold retired rings, which are freed at destroy time.
+typedef struct wsdeque {
+  atomic_int_fast64_t top, bottom;
+  _Atomic(wsdeque_buffer_t*) buffer;
+  size_t record_size;
+  dstack_t retired;
+} wsdeque_t;
+
+/*----- Function Declarations -----*/
+
+// Lifecycle functions
+int wsdeque_init(wsdeque_t* dq, size_t record_size);
+void wsdeque_destroy(wsdeque_t* dq);
+
+// Owner operations
+// Only the thread that owns the deque may call these.
+int wsdeque_push(wsdeque_t* dq, void const* val);
+int wsdeque_pop(wsdeque_t* dq, void* out);
+
+// Thief operations
+// Any thread may call these. wsdeque_steal fails with ENOENT
+// when the deque is empty, and EAGAIN when it lost a race
+// for the top record, in which case it's worth trying again.
+int wsdeque_steal(wsdeque_t* dq, void* out);
+size_t wsdeque_size(wsdeque_t const* dq);
+
+#endif